@@ -0,0 +1,111 @@
+// HMAC-SHA1 on top of the SHA-1 block function.
+
+#include "hmac_sha1.h"
+
+#include <string.h>
+
+#define IPAD 0x36
+#define OPAD 0x5c
+
+// Store 32-bit word in big-endian byte order.
+static inline void store_be32(uint8_t *p, uint32_t x) {
+    p[0] = (uint8_t)(x >> 24);
+    p[1] = (uint8_t)(x >> 16);
+    p[2] = (uint8_t)(x >> 8);
+    p[3] = (uint8_t)x;
+}
+
+// Store 64-bit word in big-endian byte order.
+static inline void store_be64(uint8_t *p, uint64_t x) {
+    store_be32(p, (uint32_t)(x >> 32));
+    store_be32(p + 4, (uint32_t)x);
+}
+
+void hmac_sha1_key_init(hmac_sha1_key *key, const uint8_t *k, size_t size) {
+    // Keys longer than a block are hashed first.
+    uint8_t block[SHA1_BLOCK_SIZE] = {0};
+    if (size > SHA1_BLOCK_SIZE) {
+        sha1_oneshot(k, size, block);
+    } else {
+        memcpy(block, k, size);
+    }
+
+    // Inner state.
+    for (size_t i = 0; i < SHA1_BLOCK_SIZE; i++) {
+        block[i] ^= IPAD;
+    }
+    sha1_state_init(key->inner);
+    sha1_blocks(key->inner, block, SHA1_BLOCK_SIZE);
+
+    // Outer state.
+    for (size_t i = 0; i < SHA1_BLOCK_SIZE; i++) {
+        block[i] ^= IPAD ^ OPAD;
+    }
+    sha1_state_init(key->outer);
+    sha1_blocks(key->outer, block, SHA1_BLOCK_SIZE);
+}
+
+// Initialize the outer message block. Only the inner digest in the first
+// SHA1_DIGEST_SIZE bytes varies between messages; the padding is fixed, since
+// the outer hash is always one key block followed by one digest.
+static void hmac_sha1_outer_init(uint8_t outer[SHA1_BLOCK_SIZE]) {
+    memset(outer, 0, SHA1_BLOCK_SIZE);
+    outer[SHA1_DIGEST_SIZE] = 0x80;
+    store_be64(outer + SHA1_BLOCK_SIZE - 8, (SHA1_BLOCK_SIZE + SHA1_DIGEST_SIZE) << 3);
+}
+
+// HMAC-SHA1 of one message, with the outer block padding already initialized.
+static void hmac_sha1_message(const hmac_sha1_key *key,
+                              const uint8_t *data,
+                              size_t size,
+                              uint8_t outer[SHA1_BLOCK_SIZE],
+                              uint8_t mac[SHA1_DIGEST_SIZE]) {
+    const uint64_t bits = ((uint64_t)size + SHA1_BLOCK_SIZE) << 3;
+    uint32_t state[5];
+
+    // Inner hash, continuing from the ipad state.
+    memcpy(state, key->inner, sizeof(state));
+    const size_t full = size - size % SHA1_BLOCK_SIZE;
+    sha1_blocks(state, data, full);
+    data += full;
+    size -= full;
+
+    uint8_t tail[2 * SHA1_BLOCK_SIZE] = {0};
+    memcpy(tail, data, size);
+    tail[size] = 0x80;
+    const size_t padded = size < SHA1_BLOCK_SIZE - 8 ? SHA1_BLOCK_SIZE : 2 * SHA1_BLOCK_SIZE;
+    store_be64(tail + padded - 8, bits);
+    sha1_blocks(state, tail, padded);
+
+    // Outer hash of the inner digest, continuing from the opad state.
+    for (size_t i = 0; i < 5; i++) {
+        store_be32(outer + 4 * i, state[i]);
+    }
+    memcpy(state, key->outer, sizeof(state));
+    sha1_blocks(state, outer, SHA1_BLOCK_SIZE);
+
+    for (size_t i = 0; i < 5; i++) {
+        store_be32(mac + 4 * i, state[i]);
+    }
+}
+
+void hmac_sha1(const hmac_sha1_key *key,
+               const uint8_t *data,
+               size_t size,
+               uint8_t mac[SHA1_DIGEST_SIZE]) {
+    uint8_t outer[SHA1_BLOCK_SIZE];
+    hmac_sha1_outer_init(outer);
+    hmac_sha1_message(key, data, size, outer, mac);
+}
+
+void hmac_sha1_batch(const hmac_sha1_key *key,
+                     const uint8_t *const *data,
+                     const size_t *sizes,
+                     size_t n,
+                     uint8_t (*macs)[SHA1_DIGEST_SIZE]) {
+    uint8_t outer[SHA1_BLOCK_SIZE];
+    hmac_sha1_outer_init(outer);
+    for (size_t i = 0; i < n; i++) {
+        hmac_sha1_message(key, data[i], sizes[i], outer, macs[i]);
+    }
+}
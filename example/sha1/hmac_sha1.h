@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sha1.h"
+
+// HMAC-SHA1 key, stored as the SHA-1 states after hashing the inner (ipad) and
+// outer (opad) key blocks. Set up once per key and reused for every message.
+typedef struct {
+    uint32_t inner[5];
+    uint32_t outer[5];
+} hmac_sha1_key;
+
+// Initialize key states from a key of any size.
+void hmac_sha1_key_init(hmac_sha1_key *key, const uint8_t *k, size_t size);
+
+// HMAC-SHA1 of one message.
+void hmac_sha1(const hmac_sha1_key *key,
+               const uint8_t *data,
+               size_t size,
+               uint8_t mac[SHA1_DIGEST_SIZE]);
+
+// HMAC-SHA1 of n messages under the same key.
+void hmac_sha1_batch(const hmac_sha1_key *key,
+                     const uint8_t *const *data,
+                     const size_t *sizes,
+                     size_t n,
+                     uint8_t (*macs)[SHA1_DIGEST_SIZE]);
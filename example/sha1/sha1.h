@@ -6,8 +6,15 @@
 // SHA-1 block size in bytes.
 #define SHA1_BLOCK_SIZE 64
 
+// SHA-1 digest size in bytes.
+#define SHA1_DIGEST_SIZE 20
+
 // Initialize provided SHA-1 state words.
 void sha1_state_init(uint32_t state[5]);
 
 // SHA-1 hash multiple blocks of data.
 void sha1_blocks(uint32_t state[5], const uint8_t *data, size_t size);
+
+// SHA-1 hash a complete message of any size. Optimized for latency of short
+// messages: state stays in registers, and the padded tail is one or two blocks.
+void sha1_oneshot(const uint8_t *data, size_t size, uint8_t digest[SHA1_DIGEST_SIZE]);
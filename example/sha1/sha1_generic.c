@@ -42,111 +42,178 @@ void sha1_state_init(uint32_t state[5]) {
     SHA1_MESSAGE_SCHEDULE(I)               \
     SHA1_ROUND0(I, A, B, C, D, E, K, F)
 
+// Hash one block of big-endian message words into the state. Always inlined,
+// so the state stays in registers across the blocks of each caller.
+static inline __attribute__((always_inline)) void sha1_block(uint32_t state[5], uint32_t W[16]) {
+    // Load state into working variables.
+    uint32_t a = state[0];
+    uint32_t b = state[1];
+    uint32_t c = state[2];
+    uint32_t d = state[3];
+    uint32_t e = state[4];
+
+    // Rounds
+    SHA1_ROUND0(0, a, b, c, d, e, K0, SHA1_CHOOSE);
+    SHA1_ROUND0(1, e, a, b, c, d, K0, SHA1_CHOOSE);
+    SHA1_ROUND0(2, d, e, a, b, c, K0, SHA1_CHOOSE);
+    SHA1_ROUND0(3, c, d, e, a, b, K0, SHA1_CHOOSE);
+    SHA1_ROUND0(4, b, c, d, e, a, K0, SHA1_CHOOSE);
+    SHA1_ROUND0(5, a, b, c, d, e, K0, SHA1_CHOOSE);
+    SHA1_ROUND0(6, e, a, b, c, d, K0, SHA1_CHOOSE);
+    SHA1_ROUND0(7, d, e, a, b, c, K0, SHA1_CHOOSE);
+    SHA1_ROUND0(8, c, d, e, a, b, K0, SHA1_CHOOSE);
+    SHA1_ROUND0(9, b, c, d, e, a, K0, SHA1_CHOOSE);
+    SHA1_ROUND0(10, a, b, c, d, e, K0, SHA1_CHOOSE);
+    SHA1_ROUND0(11, e, a, b, c, d, K0, SHA1_CHOOSE);
+    SHA1_ROUND0(12, d, e, a, b, c, K0, SHA1_CHOOSE);
+    SHA1_ROUND0(13, c, d, e, a, b, K0, SHA1_CHOOSE);
+    SHA1_ROUND0(14, b, c, d, e, a, K0, SHA1_CHOOSE);
+    SHA1_ROUND0(15, a, b, c, d, e, K0, SHA1_CHOOSE);
+    SHA1_ROUND(16, e, a, b, c, d, K0, SHA1_CHOOSE);
+    SHA1_ROUND(17, d, e, a, b, c, K0, SHA1_CHOOSE);
+    SHA1_ROUND(18, c, d, e, a, b, K0, SHA1_CHOOSE);
+    SHA1_ROUND(19, b, c, d, e, a, K0, SHA1_CHOOSE);
+    SHA1_ROUND(20, a, b, c, d, e, K1, SHA1_PARITY);
+    SHA1_ROUND(21, e, a, b, c, d, K1, SHA1_PARITY);
+    SHA1_ROUND(22, d, e, a, b, c, K1, SHA1_PARITY);
+    SHA1_ROUND(23, c, d, e, a, b, K1, SHA1_PARITY);
+    SHA1_ROUND(24, b, c, d, e, a, K1, SHA1_PARITY);
+    SHA1_ROUND(25, a, b, c, d, e, K1, SHA1_PARITY);
+    SHA1_ROUND(26, e, a, b, c, d, K1, SHA1_PARITY);
+    SHA1_ROUND(27, d, e, a, b, c, K1, SHA1_PARITY);
+    SHA1_ROUND(28, c, d, e, a, b, K1, SHA1_PARITY);
+    SHA1_ROUND(29, b, c, d, e, a, K1, SHA1_PARITY);
+    SHA1_ROUND(30, a, b, c, d, e, K1, SHA1_PARITY);
+    SHA1_ROUND(31, e, a, b, c, d, K1, SHA1_PARITY);
+    SHA1_ROUND(32, d, e, a, b, c, K1, SHA1_PARITY);
+    SHA1_ROUND(33, c, d, e, a, b, K1, SHA1_PARITY);
+    SHA1_ROUND(34, b, c, d, e, a, K1, SHA1_PARITY);
+    SHA1_ROUND(35, a, b, c, d, e, K1, SHA1_PARITY);
+    SHA1_ROUND(36, e, a, b, c, d, K1, SHA1_PARITY);
+    SHA1_ROUND(37, d, e, a, b, c, K1, SHA1_PARITY);
+    SHA1_ROUND(38, c, d, e, a, b, K1, SHA1_PARITY);
+    SHA1_ROUND(39, b, c, d, e, a, K1, SHA1_PARITY);
+    SHA1_ROUND(40, a, b, c, d, e, K2, SHA1_MAJORITY);
+    SHA1_ROUND(41, e, a, b, c, d, K2, SHA1_MAJORITY);
+    SHA1_ROUND(42, d, e, a, b, c, K2, SHA1_MAJORITY);
+    SHA1_ROUND(43, c, d, e, a, b, K2, SHA1_MAJORITY);
+    SHA1_ROUND(44, b, c, d, e, a, K2, SHA1_MAJORITY);
+    SHA1_ROUND(45, a, b, c, d, e, K2, SHA1_MAJORITY);
+    SHA1_ROUND(46, e, a, b, c, d, K2, SHA1_MAJORITY);
+    SHA1_ROUND(47, d, e, a, b, c, K2, SHA1_MAJORITY);
+    SHA1_ROUND(48, c, d, e, a, b, K2, SHA1_MAJORITY);
+    SHA1_ROUND(49, b, c, d, e, a, K2, SHA1_MAJORITY);
+    SHA1_ROUND(50, a, b, c, d, e, K2, SHA1_MAJORITY);
+    SHA1_ROUND(51, e, a, b, c, d, K2, SHA1_MAJORITY);
+    SHA1_ROUND(52, d, e, a, b, c, K2, SHA1_MAJORITY);
+    SHA1_ROUND(53, c, d, e, a, b, K2, SHA1_MAJORITY);
+    SHA1_ROUND(54, b, c, d, e, a, K2, SHA1_MAJORITY);
+    SHA1_ROUND(55, a, b, c, d, e, K2, SHA1_MAJORITY);
+    SHA1_ROUND(56, e, a, b, c, d, K2, SHA1_MAJORITY);
+    SHA1_ROUND(57, d, e, a, b, c, K2, SHA1_MAJORITY);
+    SHA1_ROUND(58, c, d, e, a, b, K2, SHA1_MAJORITY);
+    SHA1_ROUND(59, b, c, d, e, a, K2, SHA1_MAJORITY);
+    SHA1_ROUND(60, a, b, c, d, e, K3, SHA1_PARITY);
+    SHA1_ROUND(61, e, a, b, c, d, K3, SHA1_PARITY);
+    SHA1_ROUND(62, d, e, a, b, c, K3, SHA1_PARITY);
+    SHA1_ROUND(63, c, d, e, a, b, K3, SHA1_PARITY);
+    SHA1_ROUND(64, b, c, d, e, a, K3, SHA1_PARITY);
+    SHA1_ROUND(65, a, b, c, d, e, K3, SHA1_PARITY);
+    SHA1_ROUND(66, e, a, b, c, d, K3, SHA1_PARITY);
+    SHA1_ROUND(67, d, e, a, b, c, K3, SHA1_PARITY);
+    SHA1_ROUND(68, c, d, e, a, b, K3, SHA1_PARITY);
+    SHA1_ROUND(69, b, c, d, e, a, K3, SHA1_PARITY);
+    SHA1_ROUND(70, a, b, c, d, e, K3, SHA1_PARITY);
+    SHA1_ROUND(71, e, a, b, c, d, K3, SHA1_PARITY);
+    SHA1_ROUND(72, d, e, a, b, c, K3, SHA1_PARITY);
+    SHA1_ROUND(73, c, d, e, a, b, K3, SHA1_PARITY);
+    SHA1_ROUND(74, b, c, d, e, a, K3, SHA1_PARITY);
+    SHA1_ROUND(75, a, b, c, d, e, K3, SHA1_PARITY);
+    SHA1_ROUND(76, e, a, b, c, d, K3, SHA1_PARITY);
+    SHA1_ROUND(77, d, e, a, b, c, K3, SHA1_PARITY);
+    SHA1_ROUND(78, c, d, e, a, b, K3, SHA1_PARITY);
+    SHA1_ROUND(79, b, c, d, e, a, K3, SHA1_PARITY);
+
+    // Combine state
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+}
+
+// Load a message block as big-endian words.
+static inline void sha1_load_block(uint32_t W[16], const uint8_t *data) {
+    for (size_t i = 0; i < 16; i++) {
+        W[i] = SHA1_LOAD_BE32(data);
+        data += 4;
+    }
+}
+
 void sha1_blocks(uint32_t state[5], const uint8_t *data, size_t size) {
     uint32_t W[16];
 
     while (size >= SHA1_BLOCK_SIZE) {
-        // Load state into working variables.
-        uint32_t a = state[0];
-        uint32_t b = state[1];
-        uint32_t c = state[2];
-        uint32_t d = state[3];
-        uint32_t e = state[4];
-
-        // Load message
-        for (size_t i = 0; i < 16; i++) {
-            W[i] = SHA1_LOAD_BE32(data);
-            data += 4;
-        }
+        sha1_load_block(W, data);
+        sha1_block(state, W);
+
+        data += SHA1_BLOCK_SIZE;
         size -= SHA1_BLOCK_SIZE;
+    }
+}
 
-        // Rounds
-        SHA1_ROUND0(0, a, b, c, d, e, K0, SHA1_CHOOSE);
-        SHA1_ROUND0(1, e, a, b, c, d, K0, SHA1_CHOOSE);
-        SHA1_ROUND0(2, d, e, a, b, c, K0, SHA1_CHOOSE);
-        SHA1_ROUND0(3, c, d, e, a, b, K0, SHA1_CHOOSE);
-        SHA1_ROUND0(4, b, c, d, e, a, K0, SHA1_CHOOSE);
-        SHA1_ROUND0(5, a, b, c, d, e, K0, SHA1_CHOOSE);
-        SHA1_ROUND0(6, e, a, b, c, d, K0, SHA1_CHOOSE);
-        SHA1_ROUND0(7, d, e, a, b, c, K0, SHA1_CHOOSE);
-        SHA1_ROUND0(8, c, d, e, a, b, K0, SHA1_CHOOSE);
-        SHA1_ROUND0(9, b, c, d, e, a, K0, SHA1_CHOOSE);
-        SHA1_ROUND0(10, a, b, c, d, e, K0, SHA1_CHOOSE);
-        SHA1_ROUND0(11, e, a, b, c, d, K0, SHA1_CHOOSE);
-        SHA1_ROUND0(12, d, e, a, b, c, K0, SHA1_CHOOSE);
-        SHA1_ROUND0(13, c, d, e, a, b, K0, SHA1_CHOOSE);
-        SHA1_ROUND0(14, b, c, d, e, a, K0, SHA1_CHOOSE);
-        SHA1_ROUND0(15, a, b, c, d, e, K0, SHA1_CHOOSE);
-        SHA1_ROUND(16, e, a, b, c, d, K0, SHA1_CHOOSE);
-        SHA1_ROUND(17, d, e, a, b, c, K0, SHA1_CHOOSE);
-        SHA1_ROUND(18, c, d, e, a, b, K0, SHA1_CHOOSE);
-        SHA1_ROUND(19, b, c, d, e, a, K0, SHA1_CHOOSE);
-        SHA1_ROUND(20, a, b, c, d, e, K1, SHA1_PARITY);
-        SHA1_ROUND(21, e, a, b, c, d, K1, SHA1_PARITY);
-        SHA1_ROUND(22, d, e, a, b, c, K1, SHA1_PARITY);
-        SHA1_ROUND(23, c, d, e, a, b, K1, SHA1_PARITY);
-        SHA1_ROUND(24, b, c, d, e, a, K1, SHA1_PARITY);
-        SHA1_ROUND(25, a, b, c, d, e, K1, SHA1_PARITY);
-        SHA1_ROUND(26, e, a, b, c, d, K1, SHA1_PARITY);
-        SHA1_ROUND(27, d, e, a, b, c, K1, SHA1_PARITY);
-        SHA1_ROUND(28, c, d, e, a, b, K1, SHA1_PARITY);
-        SHA1_ROUND(29, b, c, d, e, a, K1, SHA1_PARITY);
-        SHA1_ROUND(30, a, b, c, d, e, K1, SHA1_PARITY);
-        SHA1_ROUND(31, e, a, b, c, d, K1, SHA1_PARITY);
-        SHA1_ROUND(32, d, e, a, b, c, K1, SHA1_PARITY);
-        SHA1_ROUND(33, c, d, e, a, b, K1, SHA1_PARITY);
-        SHA1_ROUND(34, b, c, d, e, a, K1, SHA1_PARITY);
-        SHA1_ROUND(35, a, b, c, d, e, K1, SHA1_PARITY);
-        SHA1_ROUND(36, e, a, b, c, d, K1, SHA1_PARITY);
-        SHA1_ROUND(37, d, e, a, b, c, K1, SHA1_PARITY);
-        SHA1_ROUND(38, c, d, e, a, b, K1, SHA1_PARITY);
-        SHA1_ROUND(39, b, c, d, e, a, K1, SHA1_PARITY);
-        SHA1_ROUND(40, a, b, c, d, e, K2, SHA1_MAJORITY);
-        SHA1_ROUND(41, e, a, b, c, d, K2, SHA1_MAJORITY);
-        SHA1_ROUND(42, d, e, a, b, c, K2, SHA1_MAJORITY);
-        SHA1_ROUND(43, c, d, e, a, b, K2, SHA1_MAJORITY);
-        SHA1_ROUND(44, b, c, d, e, a, K2, SHA1_MAJORITY);
-        SHA1_ROUND(45, a, b, c, d, e, K2, SHA1_MAJORITY);
-        SHA1_ROUND(46, e, a, b, c, d, K2, SHA1_MAJORITY);
-        SHA1_ROUND(47, d, e, a, b, c, K2, SHA1_MAJORITY);
-        SHA1_ROUND(48, c, d, e, a, b, K2, SHA1_MAJORITY);
-        SHA1_ROUND(49, b, c, d, e, a, K2, SHA1_MAJORITY);
-        SHA1_ROUND(50, a, b, c, d, e, K2, SHA1_MAJORITY);
-        SHA1_ROUND(51, e, a, b, c, d, K2, SHA1_MAJORITY);
-        SHA1_ROUND(52, d, e, a, b, c, K2, SHA1_MAJORITY);
-        SHA1_ROUND(53, c, d, e, a, b, K2, SHA1_MAJORITY);
-        SHA1_ROUND(54, b, c, d, e, a, K2, SHA1_MAJORITY);
-        SHA1_ROUND(55, a, b, c, d, e, K2, SHA1_MAJORITY);
-        SHA1_ROUND(56, e, a, b, c, d, K2, SHA1_MAJORITY);
-        SHA1_ROUND(57, d, e, a, b, c, K2, SHA1_MAJORITY);
-        SHA1_ROUND(58, c, d, e, a, b, K2, SHA1_MAJORITY);
-        SHA1_ROUND(59, b, c, d, e, a, K2, SHA1_MAJORITY);
-        SHA1_ROUND(60, a, b, c, d, e, K3, SHA1_PARITY);
-        SHA1_ROUND(61, e, a, b, c, d, K3, SHA1_PARITY);
-        SHA1_ROUND(62, d, e, a, b, c, K3, SHA1_PARITY);
-        SHA1_ROUND(63, c, d, e, a, b, K3, SHA1_PARITY);
-        SHA1_ROUND(64, b, c, d, e, a, K3, SHA1_PARITY);
-        SHA1_ROUND(65, a, b, c, d, e, K3, SHA1_PARITY);
-        SHA1_ROUND(66, e, a, b, c, d, K3, SHA1_PARITY);
-        SHA1_ROUND(67, d, e, a, b, c, K3, SHA1_PARITY);
-        SHA1_ROUND(68, c, d, e, a, b, K3, SHA1_PARITY);
-        SHA1_ROUND(69, b, c, d, e, a, K3, SHA1_PARITY);
-        SHA1_ROUND(70, a, b, c, d, e, K3, SHA1_PARITY);
-        SHA1_ROUND(71, e, a, b, c, d, K3, SHA1_PARITY);
-        SHA1_ROUND(72, d, e, a, b, c, K3, SHA1_PARITY);
-        SHA1_ROUND(73, c, d, e, a, b, K3, SHA1_PARITY);
-        SHA1_ROUND(74, b, c, d, e, a, K3, SHA1_PARITY);
-        SHA1_ROUND(75, a, b, c, d, e, K3, SHA1_PARITY);
-        SHA1_ROUND(76, e, a, b, c, d, K3, SHA1_PARITY);
-        SHA1_ROUND(77, d, e, a, b, c, K3, SHA1_PARITY);
-        SHA1_ROUND(78, c, d, e, a, b, K3, SHA1_PARITY);
-        SHA1_ROUND(79, b, c, d, e, a, K3, SHA1_PARITY);
-
-        // Combine state
-        state[0] += a;
-        state[1] += b;
-        state[2] += c;
-        state[3] += d;
-        state[4] += e;
+// Load the word of the padded message tail at the given offset: directly from
+// the message, with the terminator in the word containing the end of the
+// message, and zero after it.
+static inline uint32_t sha1_load_tail(const uint8_t *data, size_t size, size_t offset) {
+    if (offset + 4 <= size) {
+        return SHA1_LOAD_BE32(data + offset);
+    }
+    if (offset > size) {
+        return 0;
+    }
+    uint32_t w = UINT32_C(0x80) << (24 - 8 * (size - offset));
+    for (size_t i = 0; i < size - offset; i++) {
+        w |= (uint32_t)data[offset + i] << (24 - 8 * i);
+    }
+    return w;
+}
+
+void sha1_oneshot(const uint8_t *data, size_t size, uint8_t digest[SHA1_DIGEST_SIZE]) {
+    const uint64_t bits = (uint64_t)size << 3;
+    uint32_t state[5];
+    uint32_t W[16];
+
+    sha1_state_init(state);
+
+    // Full blocks
+    while (size >= SHA1_BLOCK_SIZE) {
+        sha1_load_block(W, data);
+        sha1_block(state, W);
+
+        data += SHA1_BLOCK_SIZE;
+        size -= SHA1_BLOCK_SIZE;
+    }
+
+    // Final blocks: one if the length fits after the terminator, otherwise two.
+    for (size_t i = 0; i < 16; i++) {
+        W[i] = sha1_load_tail(data, size, 4 * i);
+    }
+    if (size >= SHA1_BLOCK_SIZE - 8) {
+        sha1_block(state, W);
+        for (size_t i = 0; i < 14; i++) {
+            W[i] = 0;
+        }
+    }
+    W[14] = (uint32_t)(bits >> 32);
+    W[15] = (uint32_t)bits;
+    sha1_block(state, W);
+
+    // Digest
+    for (size_t i = 0; i < 5; i++) {
+        digest[4 * i + 0] = (uint8_t)(state[i] >> 24);
+        digest[4 * i + 1] = (uint8_t)(state[i] >> 16);
+        digest[4 * i + 2] = (uint8_t)(state[i] >> 8);
+        digest[4 * i + 3] = (uint8_t)state[i];
     }
 }
@@ -0,0 +1,95 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "hmac_sha1.h"
+
+#define BATCH_SIZE 64
+#define ITERATIONS (UINT64_C(1) << 12)
+#define TOTAL_MESSAGES (BATCH_SIZE * ITERATIONS)
+
+static const size_t message_sizes[] = {0, 16, 32, 55, 64, 128};
+#define NUM_MESSAGE_SIZES (sizeof(message_sizes) / sizeof(message_sizes[0]))
+#define MAX_MESSAGE_SIZE 128
+
+static uint64_t nanotime() {
+    struct timespec ts;
+    const int status = clock_gettime(CLOCK_MONOTONIC, &ts);
+    if (status != 0) {
+        abort();
+    }
+    return (uint64_t)ts.tv_sec * UINT64_C(1000000000) + ts.tv_nsec;
+}
+
+static double messages_per_sec(uint64_t elapsed_ns) {
+    return (double)TOTAL_MESSAGES * 1e9 / (double)elapsed_ns;
+}
+
+int main() {
+    // Messages.
+    uint8_t messages[BATCH_SIZE][MAX_MESSAGE_SIZE];
+    const uint8_t *data[BATCH_SIZE];
+    size_t sizes[BATCH_SIZE];
+    for (size_t i = 0; i < BATCH_SIZE; i++) {
+        for (size_t j = 0; j < MAX_MESSAGE_SIZE; j++) {
+            messages[i][j] = (uint8_t)(i + j);
+        }
+        data[i] = messages[i];
+    }
+    uint8_t macs[BATCH_SIZE][SHA1_DIGEST_SIZE];
+    uint32_t check = 0;
+
+    const uint8_t k[] = "0123456789abcdef0123";
+    hmac_sha1_key key;
+    hmac_sha1_key_init(&key, k, sizeof(k) - 1);
+
+    // Report.
+    printf("{\n");
+
+    // Parameters.
+    printf("  \"batch_size\": %d,\n", BATCH_SIZE);
+    printf("  \"iterations\": %" PRIu64 ",\n", ITERATIONS);
+    printf("  \"total_messages\": %" PRIu64 ",\n", TOTAL_MESSAGES);
+
+    // Benchmark each size, with the key set up once ("precomputed") and, for
+    // comparison, set up again for every message ("naive").
+    printf("  \"results\": [\n");
+    for (size_t s = 0; s < NUM_MESSAGE_SIZES; s++) {
+        const size_t size = message_sizes[s];
+        for (size_t i = 0; i < BATCH_SIZE; i++) {
+            sizes[i] = size;
+        }
+
+        uint64_t start = nanotime();
+        for (size_t i = 0; i < ITERATIONS; i++) {
+            hmac_sha1_batch(&key, data, sizes, BATCH_SIZE, macs);
+            check += macs[BATCH_SIZE - 1][0];
+        }
+        const uint64_t precomputed_ns = nanotime() - start;
+
+        start = nanotime();
+        for (size_t i = 0; i < ITERATIONS; i++) {
+            for (size_t j = 0; j < BATCH_SIZE; j++) {
+                hmac_sha1_key naive;
+                hmac_sha1_key_init(&naive, k, sizeof(k) - 1);
+                hmac_sha1(&naive, data[j], size, macs[j]);
+            }
+            check += macs[BATCH_SIZE - 1][0];
+        }
+        const uint64_t naive_ns = nanotime() - start;
+
+        const char *sep = s + 1 == NUM_MESSAGE_SIZES ? "" : ",";
+        printf("    {\"message_size\": %zu, \"precomputed_messages_per_sec\": %.0f, "
+               "\"naive_messages_per_sec\": %.0f}%s\n",
+               size, messages_per_sec(precomputed_ns), messages_per_sec(naive_ns), sep);
+    }
+    printf("  ],\n");
+
+    // Check byte: include to prevent dead code elimination.
+    printf("  \"check\": \"%08" PRIx32 "\"\n", check);
+
+    printf("}\n");
+
+    return EXIT_SUCCESS;
+}
@@ -3,6 +3,8 @@
 // Adapted from the public domain implementation:
 //  https://github.com/noloader/SHA-Intrinsics/blob/4899efc81d1af159c1fd955936c673139f35aea9/sha1-arm.c
 
+#include <string.h>
+
 #include "intrinsics.h"
 #include "sha1.h"
 
@@ -20,171 +22,172 @@ void sha1_state_init(uint32_t state[5]) {
     state[4] = 0xc3d2e1f0;
 }
 
-void sha1_blocks(uint32_t state[5], const uint8_t *data, size_t size) {
-    uint32x4_t abcd, abcd_saved;
+// Load 16 bytes of message as big-endian words.
+static inline uint32x4_t sha1_load_be(const uint8_t *data) {
+    uint32x4_t m = vld1q_u32((const uint32_t *)data);
+    return vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(m)));
+}
+
+// Hash one block of big-endian message words into the state. Always inlined,
+// so the state stays in registers across the blocks of each caller.
+static inline __attribute__((always_inline)) void sha1_block(uint32x4_t *abcd_state,
+                                                             uint32_t *e_state,
+                                                             uint32x4_t m0,
+                                                             uint32x4_t m1,
+                                                             uint32x4_t m2,
+                                                             uint32x4_t m3) {
+    uint32x4_t abcd = *abcd_state;
+    uint32_t e0 = *e_state, e1;
     uint32x4_t t0, t1;
-    uint32x4_t m0, m1, m2, m3;
-    uint32_t e0, e0_saved, e1;
 
+    t0 = vaddq_u32(m0, vdupq_n_u32(K0));
+    t1 = vaddq_u32(m1, vdupq_n_u32(K0));
+
+    // Rounds 0-3
+    e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+    abcd = vsha1cq_u32(abcd, e0, t0);
+    t0 = vaddq_u32(m2, vdupq_n_u32(K0));
+    m0 = vsha1su0q_u32(m0, m1, m2);
+
+    // Rounds 4-7
+    e0 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+    abcd = vsha1cq_u32(abcd, e1, t1);
+    t1 = vaddq_u32(m3, vdupq_n_u32(K0));
+    m0 = vsha1su1q_u32(m0, m3);
+    m1 = vsha1su0q_u32(m1, m2, m3);
+
+    // Rounds 8-11
+    e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+    abcd = vsha1cq_u32(abcd, e0, t0);
+    t0 = vaddq_u32(m0, vdupq_n_u32(K0));
+    m1 = vsha1su1q_u32(m1, m0);
+    m2 = vsha1su0q_u32(m2, m3, m0);
+
+    // Rounds 12-15
+    e0 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+    abcd = vsha1cq_u32(abcd, e1, t1);
+    t1 = vaddq_u32(m1, vdupq_n_u32(K1));
+    m2 = vsha1su1q_u32(m2, m1);
+    m3 = vsha1su0q_u32(m3, m0, m1);
+
+    // Rounds 16-19
+    e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+    abcd = vsha1cq_u32(abcd, e0, t0);
+    t0 = vaddq_u32(m2, vdupq_n_u32(K1));
+    m3 = vsha1su1q_u32(m3, m2);
+    m0 = vsha1su0q_u32(m0, m1, m2);
+
+    // Rounds 20-23
+    e0 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+    abcd = vsha1pq_u32(abcd, e1, t1);
+    t1 = vaddq_u32(m3, vdupq_n_u32(K1));
+    m0 = vsha1su1q_u32(m0, m3);
+    m1 = vsha1su0q_u32(m1, m2, m3);
+
+    // Rounds 24-27
+    e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+    abcd = vsha1pq_u32(abcd, e0, t0);
+    t0 = vaddq_u32(m0, vdupq_n_u32(K1));
+    m1 = vsha1su1q_u32(m1, m0);
+    m2 = vsha1su0q_u32(m2, m3, m0);
+
+    // Rounds 28-31
+    e0 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+    abcd = vsha1pq_u32(abcd, e1, t1);
+    t1 = vaddq_u32(m1, vdupq_n_u32(K1));
+    m2 = vsha1su1q_u32(m2, m1);
+    m3 = vsha1su0q_u32(m3, m0, m1);
+
+    // Rounds 32-35
+    e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+    abcd = vsha1pq_u32(abcd, e0, t0);
+    t0 = vaddq_u32(m2, vdupq_n_u32(K2));
+    m3 = vsha1su1q_u32(m3, m2);
+    m0 = vsha1su0q_u32(m0, m1, m2);
+
+    // Rounds 36-39
+    e0 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+    abcd = vsha1pq_u32(abcd, e1, t1);
+    t1 = vaddq_u32(m3, vdupq_n_u32(K2));
+    m0 = vsha1su1q_u32(m0, m3);
+    m1 = vsha1su0q_u32(m1, m2, m3);
+
+    // Rounds 40-43
+    e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+    abcd = vsha1mq_u32(abcd, e0, t0);
+    t0 = vaddq_u32(m0, vdupq_n_u32(K2));
+    m1 = vsha1su1q_u32(m1, m0);
+    m2 = vsha1su0q_u32(m2, m3, m0);
+
+    // Rounds 44-47
+    e0 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+    abcd = vsha1mq_u32(abcd, e1, t1);
+    t1 = vaddq_u32(m1, vdupq_n_u32(K2));
+    m2 = vsha1su1q_u32(m2, m1);
+    m3 = vsha1su0q_u32(m3, m0, m1);
+
+    // Rounds 48-51
+    e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+    abcd = vsha1mq_u32(abcd, e0, t0);
+    t0 = vaddq_u32(m2, vdupq_n_u32(K2));
+    m3 = vsha1su1q_u32(m3, m2);
+    m0 = vsha1su0q_u32(m0, m1, m2);
+
+    // Rounds 52-55
+    e0 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+    abcd = vsha1mq_u32(abcd, e1, t1);
+    t1 = vaddq_u32(m3, vdupq_n_u32(K3));
+    m0 = vsha1su1q_u32(m0, m3);
+    m1 = vsha1su0q_u32(m1, m2, m3);
+
+    // Rounds 56-59
+    e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+    abcd = vsha1mq_u32(abcd, e0, t0);
+    t0 = vaddq_u32(m0, vdupq_n_u32(K3));
+    m1 = vsha1su1q_u32(m1, m0);
+    m2 = vsha1su0q_u32(m2, m3, m0);
+
+    // Rounds 60-63
+    e0 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+    abcd = vsha1pq_u32(abcd, e1, t1);
+    t1 = vaddq_u32(m1, vdupq_n_u32(K3));
+    m2 = vsha1su1q_u32(m2, m1);
+    m3 = vsha1su0q_u32(m3, m0, m1);
+
+    // Rounds 64-67
+    e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+    abcd = vsha1pq_u32(abcd, e0, t0);
+    t0 = vaddq_u32(m2, vdupq_n_u32(K3));
+    m3 = vsha1su1q_u32(m3, m2);
+    m0 = vsha1su0q_u32(m0, m1, m2);
+
+    // Rounds 68-71
+    e0 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+    abcd = vsha1pq_u32(abcd, e1, t1);
+    t1 = vaddq_u32(m3, vdupq_n_u32(K3));
+    m0 = vsha1su1q_u32(m0, m3);
+
+    // Rounds 72-75
+    e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+    abcd = vsha1pq_u32(abcd, e0, t0);
+
+    // Rounds 76-79
+    e0 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+    abcd = vsha1pq_u32(abcd, e1, t1);
+
+    // Combine state
+    *e_state += e0;
+    *abcd_state = vaddq_u32(*abcd_state, abcd);
+}
+
+void sha1_blocks(uint32_t state[5], const uint8_t *data, size_t size) {
     // Load state
-    abcd = vld1q_u32(&state[0]);
-    e0 = state[4];
+    uint32x4_t abcd = vld1q_u32(&state[0]);
+    uint32_t e = state[4];
 
     while (size >= SHA1_BLOCK_SIZE) {
-        // Save state
-        abcd_saved = abcd;
-        e0_saved = e0;
-
-        // Load message
-        m0 = vld1q_u32((const uint32_t *)(data));
-        m1 = vld1q_u32((const uint32_t *)(data + 16));
-        m2 = vld1q_u32((const uint32_t *)(data + 32));
-        m3 = vld1q_u32((const uint32_t *)(data + 48));
-
-        // Reverse for little endian
-        m0 = vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(m0)));
-        m1 = vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(m1)));
-        m2 = vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(m2)));
-        m3 = vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(m3)));
-
-        t0 = vaddq_u32(m0, vdupq_n_u32(K0));
-        t1 = vaddq_u32(m1, vdupq_n_u32(K0));
-
-        // Rounds 0-3
-        e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
-        abcd = vsha1cq_u32(abcd, e0, t0);
-        t0 = vaddq_u32(m2, vdupq_n_u32(K0));
-        m0 = vsha1su0q_u32(m0, m1, m2);
-
-        // Rounds 4-7
-        e0 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
-        abcd = vsha1cq_u32(abcd, e1, t1);
-        t1 = vaddq_u32(m3, vdupq_n_u32(K0));
-        m0 = vsha1su1q_u32(m0, m3);
-        m1 = vsha1su0q_u32(m1, m2, m3);
-
-        // Rounds 8-11
-        e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
-        abcd = vsha1cq_u32(abcd, e0, t0);
-        t0 = vaddq_u32(m0, vdupq_n_u32(K0));
-        m1 = vsha1su1q_u32(m1, m0);
-        m2 = vsha1su0q_u32(m2, m3, m0);
-
-        // Rounds 12-15
-        e0 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
-        abcd = vsha1cq_u32(abcd, e1, t1);
-        t1 = vaddq_u32(m1, vdupq_n_u32(K1));
-        m2 = vsha1su1q_u32(m2, m1);
-        m3 = vsha1su0q_u32(m3, m0, m1);
-
-        // Rounds 16-19
-        e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
-        abcd = vsha1cq_u32(abcd, e0, t0);
-        t0 = vaddq_u32(m2, vdupq_n_u32(K1));
-        m3 = vsha1su1q_u32(m3, m2);
-        m0 = vsha1su0q_u32(m0, m1, m2);
-
-        // Rounds 20-23
-        e0 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
-        abcd = vsha1pq_u32(abcd, e1, t1);
-        t1 = vaddq_u32(m3, vdupq_n_u32(K1));
-        m0 = vsha1su1q_u32(m0, m3);
-        m1 = vsha1su0q_u32(m1, m2, m3);
-
-        // Rounds 24-27
-        e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
-        abcd = vsha1pq_u32(abcd, e0, t0);
-        t0 = vaddq_u32(m0, vdupq_n_u32(K1));
-        m1 = vsha1su1q_u32(m1, m0);
-        m2 = vsha1su0q_u32(m2, m3, m0);
-
-        // Rounds 28-31
-        e0 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
-        abcd = vsha1pq_u32(abcd, e1, t1);
-        t1 = vaddq_u32(m1, vdupq_n_u32(K1));
-        m2 = vsha1su1q_u32(m2, m1);
-        m3 = vsha1su0q_u32(m3, m0, m1);
-
-        // Rounds 32-35
-        e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
-        abcd = vsha1pq_u32(abcd, e0, t0);
-        t0 = vaddq_u32(m2, vdupq_n_u32(K2));
-        m3 = vsha1su1q_u32(m3, m2);
-        m0 = vsha1su0q_u32(m0, m1, m2);
-
-        // Rounds 36-39
-        e0 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
-        abcd = vsha1pq_u32(abcd, e1, t1);
-        t1 = vaddq_u32(m3, vdupq_n_u32(K2));
-        m0 = vsha1su1q_u32(m0, m3);
-        m1 = vsha1su0q_u32(m1, m2, m3);
-
-        // Rounds 40-43
-        e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
-        abcd = vsha1mq_u32(abcd, e0, t0);
-        t0 = vaddq_u32(m0, vdupq_n_u32(K2));
-        m1 = vsha1su1q_u32(m1, m0);
-        m2 = vsha1su0q_u32(m2, m3, m0);
-
-        // Rounds 44-47
-        e0 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
-        abcd = vsha1mq_u32(abcd, e1, t1);
-        t1 = vaddq_u32(m1, vdupq_n_u32(K2));
-        m2 = vsha1su1q_u32(m2, m1);
-        m3 = vsha1su0q_u32(m3, m0, m1);
-
-        // Rounds 48-51
-        e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
-        abcd = vsha1mq_u32(abcd, e0, t0);
-        t0 = vaddq_u32(m2, vdupq_n_u32(K2));
-        m3 = vsha1su1q_u32(m3, m2);
-        m0 = vsha1su0q_u32(m0, m1, m2);
-
-        // Rounds 52-55
-        e0 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
-        abcd = vsha1mq_u32(abcd, e1, t1);
-        t1 = vaddq_u32(m3, vdupq_n_u32(K3));
-        m0 = vsha1su1q_u32(m0, m3);
-        m1 = vsha1su0q_u32(m1, m2, m3);
-
-        // Rounds 56-59
-        e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
-        abcd = vsha1mq_u32(abcd, e0, t0);
-        t0 = vaddq_u32(m0, vdupq_n_u32(K3));
-        m1 = vsha1su1q_u32(m1, m0);
-        m2 = vsha1su0q_u32(m2, m3, m0);
-
-        // Rounds 60-63
-        e0 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
-        abcd = vsha1pq_u32(abcd, e1, t1);
-        t1 = vaddq_u32(m1, vdupq_n_u32(K3));
-        m2 = vsha1su1q_u32(m2, m1);
-        m3 = vsha1su0q_u32(m3, m0, m1);
-
-        // Rounds 64-67
-        e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
-        abcd = vsha1pq_u32(abcd, e0, t0);
-        t0 = vaddq_u32(m2, vdupq_n_u32(K3));
-        m3 = vsha1su1q_u32(m3, m2);
-        m0 = vsha1su0q_u32(m0, m1, m2);
-
-        // Rounds 68-71
-        e0 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
-        abcd = vsha1pq_u32(abcd, e1, t1);
-        t1 = vaddq_u32(m3, vdupq_n_u32(K3));
-        m0 = vsha1su1q_u32(m0, m3);
-
-        // Rounds 72-75
-        e1 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
-        abcd = vsha1pq_u32(abcd, e0, t0);
-
-        // Rounds 76-79
-        e0 = vsha1h_u32(vgetq_lane_u32(abcd, 0));
-        abcd = vsha1pq_u32(abcd, e1, t1);
-
-        // Combine state
-        e0 += e0_saved;
-        abcd = vaddq_u32(abcd_saved, abcd);
+        sha1_block(&abcd, &e, sha1_load_be(data), sha1_load_be(data + 16), sha1_load_be(data + 32),
+                   sha1_load_be(data + 48));
 
         data += SHA1_BLOCK_SIZE;
         size -= SHA1_BLOCK_SIZE;
@@ -192,5 +195,68 @@ void sha1_blocks(uint32_t state[5], const uint8_t *data, size_t size) {
 
     // Save state
     vst1q_u32(&state[0], abcd);
-    state[4] = e0;
+    state[4] = e;
+}
+
+// Load 16 bytes of the padded message tail at the given offset. Chunks inside
+// the message are loaded directly, and chunks past its end are constant. Only
+// the chunk containing the end of the message is copied, to avoid reading past
+// the input.
+static inline uint32x4_t sha1_load_tail(const uint8_t *data, size_t size, size_t offset) {
+    static const uint32_t terminator[4] = {0x80000000, 0, 0, 0};
+    if (offset + 16 <= size) {
+        return sha1_load_be(data + offset);
+    }
+    if (offset > size) {
+        return vdupq_n_u32(0);
+    }
+    if (offset == size) {
+        return vld1q_u32(terminator);
+    }
+    uint8_t chunk[16] = {0};
+    memcpy(chunk, data + offset, size - offset);
+    chunk[size - offset] = 0x80;
+    return sha1_load_be(chunk);
+}
+
+void sha1_oneshot(const uint8_t *data, size_t size, uint8_t digest[SHA1_DIGEST_SIZE]) {
+    const uint64_t bits = (uint64_t)size << 3;
+
+    // Initial state
+    uint32_t state[5];
+    sha1_state_init(state);
+    uint32x4_t abcd = vld1q_u32(&state[0]);
+    uint32_t e = state[4];
+
+    // Full blocks
+    while (size >= SHA1_BLOCK_SIZE) {
+        sha1_block(&abcd, &e, sha1_load_be(data), sha1_load_be(data + 16), sha1_load_be(data + 32),
+                   sha1_load_be(data + 48));
+
+        data += SHA1_BLOCK_SIZE;
+        size -= SHA1_BLOCK_SIZE;
+    }
+
+    // Final blocks: one if the length fits after the terminator, otherwise two.
+    // The length is added to the last chunk, whose final words are zero.
+    const uint32_t length[4] = {0, 0, (uint32_t)(bits >> 32), (uint32_t)bits};
+    const uint32x4_t m_length = vld1q_u32(length);
+    const uint32x4_t m0 = sha1_load_tail(data, size, 0);
+    const uint32x4_t m1 = sha1_load_tail(data, size, 16);
+    const uint32x4_t m2 = sha1_load_tail(data, size, 32);
+    const uint32x4_t m3 = sha1_load_tail(data, size, 48);
+    if (size < SHA1_BLOCK_SIZE - 8) {
+        sha1_block(&abcd, &e, m0, m1, m2, vaddq_u32(m3, m_length));
+    } else {
+        const uint32x4_t zero = vdupq_n_u32(0);
+        sha1_block(&abcd, &e, m0, m1, m2, m3);
+        sha1_block(&abcd, &e, zero, zero, zero, m_length);
+    }
+
+    // Digest
+    vst1q_u32((uint32_t *)digest, vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(abcd))));
+    digest[16] = (uint8_t)(e >> 24);
+    digest[17] = (uint8_t)(e >> 16);
+    digest[18] = (uint8_t)(e >> 8);
+    digest[19] = (uint8_t)e;
 }
@@ -0,0 +1,74 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sha1.h"
+
+#define MAX_MESSAGE_SIZE 128
+#define ITERATIONS (UINT64_C(1) << 16)
+
+// Zero that the compiler cannot see through, used to make the message size
+// depend on the previous digest.
+static volatile uint8_t zero = 0;
+
+static uint64_t nanotime() {
+    struct timespec ts;
+    const int status = clock_gettime(CLOCK_MONOTONIC, &ts);
+    if (status != 0) {
+        abort();
+    }
+    return (uint64_t)ts.tv_sec * UINT64_C(1000000000) + ts.tv_nsec;
+}
+
+int main() {
+    uint8_t message[MAX_MESSAGE_SIZE] = {0};
+    for (size_t i = 0; i < MAX_MESSAGE_SIZE; i++) {
+        message[i] = (uint8_t)i;
+    }
+    uint8_t digest[SHA1_DIGEST_SIZE] = {0};
+    const uint8_t mask = zero;
+
+    // Report.
+    printf("{\n");
+
+    // Parameters.
+    printf("  \"max_message_size\": %d,\n", MAX_MESSAGE_SIZE);
+    printf("  \"iterations\": %" PRIu64 ",\n", ITERATIONS);
+
+    // Benchmark each size. Each digest is mixed into the next message, so
+    // calls are serialized and the timing measures latency, not throughput.
+    // The message size also depends on the digest, which carries the
+    // dependency into the length words of the final block, including for
+    // empty messages.
+    printf("  \"results\": [\n");
+    for (size_t size = 0; size <= MAX_MESSAGE_SIZE; size++) {
+        const uint64_t start = nanotime();
+        for (size_t i = 0; i < ITERATIONS; i++) {
+            for (size_t j = 0; j < size && j < SHA1_DIGEST_SIZE; j++) {
+                message[j] ^= digest[j];
+            }
+            sha1_oneshot(message, size + (digest[0] & mask), digest);
+        }
+        const uint64_t end = nanotime();
+        const uint64_t elapsed_ns = end - start;
+
+        const char *sep = size == MAX_MESSAGE_SIZE ? "" : ",";
+        printf("    {\"message_size\": %zu, \"elapsed_ns\": %" PRIu64
+               ", \"ns_per_message\": %.2f}%s\n",
+               size, elapsed_ns, (double)elapsed_ns / ITERATIONS, sep);
+    }
+    printf("  ],\n");
+
+    // Digest: include for comparison and to prevent dead code elimination.
+    printf("  \"final_digest\": \"");
+    for (size_t i = 0; i < SHA1_DIGEST_SIZE; i++) {
+        printf("%02" PRIx8, digest[i]);
+    }
+    printf("\"\n");
+
+    printf("}\n");
+
+    return EXIT_SUCCESS;
+}
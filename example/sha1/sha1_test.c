@@ -1,8 +1,29 @@
+#include "hmac_sha1.h"
 #include "sha1.h"
 
 #include <stdlib.h>
 #include <string.h>
 
+// Reference hash of a message of any size by padding and calling sha1_blocks.
+static void sha1_padded(const uint8_t *data, size_t size, uint8_t digest[SHA1_DIGEST_SIZE]) {
+    uint8_t message[4 * SHA1_BLOCK_SIZE] = {0};
+    const uint64_t bits = (uint64_t)size << 3;
+    const size_t padded = (size + 8) / SHA1_BLOCK_SIZE * SHA1_BLOCK_SIZE + SHA1_BLOCK_SIZE;
+    memcpy(message, data, size);
+    message[size] = 0x80;
+    for (size_t i = 0; i < 8; i++) {
+        message[padded - 1 - i] = (uint8_t)(bits >> (8 * i));
+    }
+
+    uint32_t state[5];
+    sha1_state_init(state);
+    sha1_blocks(state, message, padded);
+
+    for (size_t i = 0; i < SHA1_DIGEST_SIZE; i++) {
+        digest[i] = (uint8_t)(state[i / 4] >> (24 - 8 * (i % 4)));
+    }
+}
+
 int main() {
     // Empty message and expected hash.
     uint8_t message[SHA1_BLOCK_SIZE] = {0x80};
@@ -18,5 +39,132 @@ int main() {
         return EXIT_FAILURE;
     }
 
+    // One-shot: known answers for the one and two final block cases.
+    const char *input = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+    const uint8_t expect_abc[SHA1_DIGEST_SIZE] = {0xa9, 0x99, 0x3e, 0x36, 0x47, 0x06, 0x81,
+                                                  0x6a, 0xba, 0x3e, 0x25, 0x71, 0x78, 0x50,
+                                                  0xc2, 0x6c, 0x9c, 0xd0, 0xd8, 0x9d};
+    const uint8_t expect_56[SHA1_DIGEST_SIZE] = {0x84, 0x98, 0x3e, 0x44, 0x1c, 0x3b, 0xd2,
+                                                 0x6e, 0xba, 0xae, 0x4a, 0xa1, 0xf9, 0x51,
+                                                 0x29, 0xe5, 0xe5, 0x46, 0x70, 0xf1};
+    uint8_t digest[SHA1_DIGEST_SIZE];
+
+    sha1_oneshot((const uint8_t *)"abc", 3, digest);
+    if (0 != memcmp(digest, expect_abc, sizeof(digest))) {
+        return EXIT_FAILURE;
+    }
+
+    sha1_oneshot((const uint8_t *)input, strlen(input), digest);
+    if (0 != memcmp(digest, expect_56, sizeof(digest))) {
+        return EXIT_FAILURE;
+    }
+
+    // One-shot: compare against padded blocks for every size over full blocks
+    // and both tail cases.
+    uint8_t data[3 * SHA1_BLOCK_SIZE];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 7 + 1);
+    }
+    for (size_t size = 0; size <= sizeof(data); size++) {
+        uint8_t got[SHA1_DIGEST_SIZE], want[SHA1_DIGEST_SIZE];
+        sha1_oneshot(data, size, got);
+        sha1_padded(data, size, want);
+        if (0 != memcmp(got, want, sizeof(got))) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    // HMAC: RFC 2202 test cases 1, 2, 6 and 7, the last two with a key longer
+    // than a block, and the last with data longer than a block.
+    uint8_t key_short[20], key_long[80];
+    memset(key_short, 0x0b, sizeof(key_short));
+    memset(key_long, 0xaa, sizeof(key_long));
+    const struct {
+        const uint8_t *key;
+        size_t key_size;
+        const char *data;
+        uint8_t mac[SHA1_DIGEST_SIZE];
+    } hmac_cases[] = {
+        {
+            key_short,
+            sizeof(key_short),
+            "Hi There",
+            {0xb6, 0x17, 0x31, 0x86, 0x55, 0x05, 0x72, 0x64, 0xe2, 0x8b,
+             0xc0, 0xb6, 0xfb, 0x37, 0x8c, 0x8e, 0xf1, 0x46, 0xbe, 0x00},
+        },
+        {
+            (const uint8_t *)"Jefe",
+            4,
+            "what do ya want for nothing?",
+            {0xef, 0xfc, 0xdf, 0x6a, 0xe5, 0xeb, 0x2f, 0xa2, 0xd2, 0x74,
+             0x16, 0xd5, 0xf1, 0x84, 0xdf, 0x9c, 0x25, 0x9a, 0x7c, 0x79},
+        },
+        {
+            key_long,
+            sizeof(key_long),
+            "Test Using Larger Than Block-Size Key - Hash Key First",
+            {0xaa, 0x4a, 0xe5, 0xe1, 0x52, 0x72, 0xd0, 0x0e, 0x95, 0x70,
+             0x56, 0x37, 0xce, 0x8a, 0x3b, 0x55, 0xed, 0x40, 0x21, 0x12},
+        },
+        {
+            key_long,
+            sizeof(key_long),
+            "Test Using Larger Than Block-Size Key and Larger Than One Block-Size Data",
+            {0xe8, 0xe9, 0x9d, 0x0f, 0x45, 0x23, 0x7d, 0x78, 0x6d, 0x6b,
+             0xba, 0xa7, 0x96, 0x5c, 0x78, 0x08, 0xbb, 0xff, 0x1a, 0x91},
+        },
+    };
+    for (size_t i = 0; i < sizeof(hmac_cases) / sizeof(hmac_cases[0]); i++) {
+        hmac_sha1_key key;
+        hmac_sha1_key_init(&key, hmac_cases[i].key, hmac_cases[i].key_size);
+        const char *text = hmac_cases[i].data;
+        hmac_sha1(&key, (const uint8_t *)text, strlen(text), digest);
+        if (0 != memcmp(digest, hmac_cases[i].mac, sizeof(digest))) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    // HMAC: known answers for a tail that needs a second padding block, and
+    // for more than one block of data.
+    hmac_sha1_key key;
+    hmac_sha1_key_init(&key, (const uint8_t *)"Jefe", 4);
+    const struct {
+        size_t size;
+        uint8_t mac[SHA1_DIGEST_SIZE];
+    } hmac_sizes[] = {
+        {
+            60,
+            {0xad, 0xa5, 0xf5, 0x59, 0x6c, 0xa9, 0xc8, 0xdf, 0xee, 0x88,
+             0xd4, 0x7a, 0xb4, 0x87, 0x98, 0x0c, 0x0e, 0x14, 0xf4, 0x9e},
+        },
+        {
+            128,
+            {0x45, 0xd7, 0x50, 0xc9, 0x33, 0x63, 0xb2, 0x6c, 0xa9, 0x14,
+             0x73, 0x07, 0xa8, 0x74, 0x6f, 0xf2, 0xd6, 0x2f, 0x02, 0xe1},
+        },
+    };
+    for (size_t i = 0; i < sizeof(hmac_sizes) / sizeof(hmac_sizes[0]); i++) {
+        hmac_sha1(&key, data, hmac_sizes[i].size, digest);
+        if (0 != memcmp(digest, hmac_sizes[i].mac, sizeof(digest))) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    // HMAC: batch matches single messages over both inner tail cases.
+    const uint8_t *batch_data[sizeof(data) + 1];
+    size_t batch_sizes[sizeof(data) + 1];
+    uint8_t batch_macs[sizeof(data) + 1][SHA1_DIGEST_SIZE];
+    for (size_t size = 0; size <= sizeof(data); size++) {
+        batch_data[size] = data;
+        batch_sizes[size] = size;
+    }
+    hmac_sha1_batch(&key, batch_data, batch_sizes, sizeof(data) + 1, batch_macs);
+    for (size_t size = 0; size <= sizeof(data); size++) {
+        hmac_sha1(&key, data, size, digest);
+        if (0 != memcmp(digest, batch_macs[size], sizeof(digest))) {
+            return EXIT_FAILURE;
+        }
+    }
+
     return EXIT_SUCCESS;
 }
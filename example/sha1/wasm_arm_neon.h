@@ -1,39 +1,34 @@
+// Code generated by tools/generate_intrinsics.py. DO NOT EDIT.
+
 #pragma once
 
 #include <wasm_simd128.h>
 
-typedef v128_t uint8x16_t;
 typedef v128_t uint32x4_t;
-
-// vaddq_u32
-
-static inline uint32x4_t vaddq_u32(uint32x4_t a, uint32x4_t b) {
-    return wasm_i32x4_add(a, b);
-}
-
-// vdupq_n_u32
-
-static inline uint32x4_t vdupq_n_u32(uint32_t value) {
-    return wasm_u32x4_splat(value);
-}
+typedef v128_t uint8x16_t;
 
 // vld1q_u32
 
-static inline uint32x4_t vld1q_u32(uint32_t const *ptr) {
+static inline uint32x4_t vld1q_u32(uint32_t const * ptr) {
     return wasm_v128_load(ptr);
 }
 
 // vst1q_u32
 
-static inline void vst1q_u32(uint32_t *ptr, uint32x4_t val) {
+static inline void vst1q_u32(uint32_t * ptr, uint32x4_t val) {
     wasm_v128_store(ptr, val);
 }
 
-// vrev32q_u8
+// vaddq_u32
 
-static inline uint8x16_t vrev32q_u8(uint8x16_t vec) {
-    return wasm_i8x16_shuffle(vec, wasm_i8x16_splat(0), 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15,
-                              14, 13, 12);
+static inline uint32x4_t vaddq_u32(uint32x4_t a, uint32x4_t b) {
+    return wasm_i32x4_add(a, b);
+}
+
+// vdupq_n_u32
+
+static inline uint32x4_t vdupq_n_u32(uint32_t value) {
+    return wasm_u32x4_splat(value);
 }
 
 // vgetq_lane_u32
@@ -65,33 +60,23 @@ static inline uint8x16_t vreinterpretq_u8_u32(uint32x4_t a) {
     return a;
 }
 
-// vsha1cq_u32
-
-uint32x4_t __intrinsic_vsha1cq_u32(uint32x4_t hash_abcd, uint32x4_t hash_e, uint32x4_t wk);
-
-static inline uint32x4_t vsha1cq_u32(uint32x4_t hash_abcd, uint32_t hash_e, uint32x4_t wk) {
-    return __intrinsic_vsha1cq_u32(hash_abcd, wasm_u32x4_splat(hash_e), wk);
-}
-
-// vsha1pq_u32
-
-uint32x4_t __intrinsic_vsha1pq_u32(uint32x4_t hash_abcd, uint32x4_t hash_e, uint32x4_t wk);
+// vrev32q_u8
 
-static inline uint32x4_t vsha1pq_u32(uint32x4_t hash_abcd, uint32_t hash_e, uint32x4_t wk) {
-    return __intrinsic_vsha1pq_u32(hash_abcd, wasm_u32x4_splat(hash_e), wk);
+static inline uint8x16_t vrev32q_u8(uint8x16_t vec) {
+    return wasm_i8x16_shuffle(vec, wasm_i8x16_splat(0), 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
 }
 
-// vsha1mq_u32
+// vsha1cq_u32
 
-uint32x4_t __intrinsic_vsha1mq_u32(uint32x4_t hash_abcd, uint32x4_t hash_e, uint32x4_t wk);
+uint32x4_t __intrinsic_vsha1cq_u32(uint32x4_t hash_abcd, v128_t hash_e, uint32x4_t wk);
 
-static inline uint32x4_t vsha1mq_u32(uint32x4_t hash_abcd, uint32_t hash_e, uint32x4_t wk) {
-    return __intrinsic_vsha1mq_u32(hash_abcd, wasm_u32x4_splat(hash_e), wk);
+static inline uint32x4_t vsha1cq_u32(uint32x4_t hash_abcd, uint32_t hash_e, uint32x4_t wk) {
+    return __intrinsic_vsha1cq_u32(hash_abcd, wasm_u32x4_splat(hash_e), wk);
 }
 
 // vsha1h_u32
 
-uint32x4_t __intrinsic_vsha1h_u32(uint32x4_t hash_e);
+v128_t __intrinsic_vsha1h_u32(v128_t hash_e);
 
 static inline uint32_t vsha1h_u32(uint32_t hash_e) {
     return wasm_u32x4_extract_lane(__intrinsic_vsha1h_u32(wasm_u32x4_splat(hash_e)), 0);
@@ -112,3 +97,19 @@ uint32x4_t __intrinsic_vsha1su1q_u32(uint32x4_t tw0_3, uint32x4_t w12_15);
 static inline uint32x4_t vsha1su1q_u32(uint32x4_t tw0_3, uint32x4_t w12_15) {
     return __intrinsic_vsha1su1q_u32(tw0_3, w12_15);
 }
+
+// vsha1pq_u32
+
+uint32x4_t __intrinsic_vsha1pq_u32(uint32x4_t hash_abcd, v128_t hash_e, uint32x4_t wk);
+
+static inline uint32x4_t vsha1pq_u32(uint32x4_t hash_abcd, uint32_t hash_e, uint32x4_t wk) {
+    return __intrinsic_vsha1pq_u32(hash_abcd, wasm_u32x4_splat(hash_e), wk);
+}
+
+// vsha1mq_u32
+
+uint32x4_t __intrinsic_vsha1mq_u32(uint32x4_t hash_abcd, v128_t hash_e, uint32x4_t wk);
+
+static inline uint32x4_t vsha1mq_u32(uint32x4_t hash_abcd, uint32_t hash_e, uint32x4_t wk) {
+    return __intrinsic_vsha1mq_u32(hash_abcd, wasm_u32x4_splat(hash_e), wk);
+}
@@ -0,0 +1,48 @@
+// Fallbacks for engine intrinsics listed in HANDWRITTEN_FALLBACKS in
+// tools/generate_intrinsics.py, which generates only their declarations.
+
+#include "wasm_arm_neon.h"
+
+#define SHA1_PARITY(X, Y, Z) (X ^ Y ^ Z)
+#define SHA1_MAJORITY(X, Y, Z) ((X & Y) | ((X | Y) & Z))
+
+#define SHA1_ROUND(F, I)                                                                    \
+    do {                                                                                    \
+        uint32_t f = F(b, c, d);                                                            \
+        uint32_t t = __builtin_rotateleft32(a, 5) + f + e + wasm_u32x4_extract_lane(wk, I); \
+        e = d;                                                                              \
+        d = c;                                                                              \
+        c = __builtin_rotateleft32(b, 30);                                                  \
+        b = a;                                                                              \
+        a = t;                                                                              \
+    } while (0)
+
+uint32x4_t __intrinsic_vsha1pq_u32(uint32x4_t hash_abcd, v128_t hash_e, uint32x4_t wk) {
+    uint32_t a = wasm_u32x4_extract_lane(hash_abcd, 0);
+    uint32_t b = wasm_u32x4_extract_lane(hash_abcd, 1);
+    uint32_t c = wasm_u32x4_extract_lane(hash_abcd, 2);
+    uint32_t d = wasm_u32x4_extract_lane(hash_abcd, 3);
+    uint32_t e = wasm_u32x4_extract_lane(hash_e, 0);
+
+    SHA1_ROUND(SHA1_PARITY, 0);
+    SHA1_ROUND(SHA1_PARITY, 1);
+    SHA1_ROUND(SHA1_PARITY, 2);
+    SHA1_ROUND(SHA1_PARITY, 3);
+
+    return wasm_u32x4_make(a, b, c, d);
+}
+
+uint32x4_t __intrinsic_vsha1mq_u32(uint32x4_t hash_abcd, v128_t hash_e, uint32x4_t wk) {
+    uint32_t a = wasm_u32x4_extract_lane(hash_abcd, 0);
+    uint32_t b = wasm_u32x4_extract_lane(hash_abcd, 1);
+    uint32_t c = wasm_u32x4_extract_lane(hash_abcd, 2);
+    uint32_t d = wasm_u32x4_extract_lane(hash_abcd, 3);
+    uint32_t e = wasm_u32x4_extract_lane(hash_e, 0);
+
+    SHA1_ROUND(SHA1_MAJORITY, 0);
+    SHA1_ROUND(SHA1_MAJORITY, 1);
+    SHA1_ROUND(SHA1_MAJORITY, 2);
+    SHA1_ROUND(SHA1_MAJORITY, 3);
+
+    return wasm_u32x4_make(a, b, c, d);
+}
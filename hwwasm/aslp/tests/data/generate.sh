@@ -76,9 +76,9 @@ testcase    "sha1c"         "sha1c q5, s6, v1.4s"
 # SHA1H: SHA1 fixed rotate.
 testcase    "sha1h"         "sha1h s17, s6"
 # SHA1M: SHA1 hash update (majority).
-testcase    "sha1m"         "sha1c q5, s6, v1.4s"
+testcase    "sha1m"         "sha1m q5, s6, v1.4s"
 # SHA1P: SHA1 hash update (parity).
-testcase    "sha1p"         "sha1c q5, s6, v1.4s"
+testcase    "sha1p"         "sha1p q5, s6, v1.4s"
 # SHA1SU0: SHA1 schedule update 0.
 testcase    "sha1su0"       "sha1su0 v3.4s, v0.4s, v1.4s"
 # SHA1SU1: SHA1 schedule update 1.
@@ -0,0 +1,303 @@
+// Emission of value graph functions as C with Wasm SIMD intrinsics.
+
+use anyhow::{bail, Result};
+
+use crate::ir::{self, Node, Value};
+
+/// Emit a C function definition with the given name and parameter names.
+///
+/// Values of 128 bits are represented as `v128_t`, and narrower values as
+/// unsigned integers of their exact width. As in lowering to Wasm, values used
+/// more than once are computed once into a local variable, and all others are
+/// emitted inline at their single use. Uses that only select lanes of an
+/// operand, rather than computing it, do not count.
+pub fn emit(name: &str, params: &[String], func: &ir::Function) -> Result<String> {
+    if params.len() != func.params.len() {
+        bail!("expected {} parameter names", func.params.len());
+    }
+    let result = match func.results.as_slice() {
+        [result] => *result,
+        _ => bail!("c functions must have a single result"),
+    };
+
+    let mut emitter = Emitter::new(func, params);
+
+    // Signature.
+    let mut decls = Vec::new();
+    for (param, ty) in params.iter().zip(&func.params) {
+        decls.push(format!("{} {param}", ctype(ty.width())?));
+    }
+    let ret = ctype(func.ty(result).width())?;
+    emitter.line(format!("{ret} {name}({}) {{", decls.join(", ")));
+
+    // Shared values.
+    for (i, node) in func.nodes.iter().enumerate() {
+        let shared = emitter.uses[i] - emitter.structural_uses[i] > 1;
+        let trivial = matches!(node, Node::Param { .. } | Node::IConst { .. });
+        if !shared || trivial {
+            continue;
+        }
+
+        let value = Value(i);
+        let ty = ctype(func.ty(value).width())?;
+        let expr = emitter.tree(value)?;
+        let var = format!("v{i}");
+        emitter.line(format!("    const {ty} {var} = {expr};"));
+        emitter.value_var[i] = Some(var);
+    }
+
+    // Result.
+    let expr = emitter.value(result)?;
+    emitter.line(format!("    return {expr};"));
+    emitter.line("}".to_string());
+
+    Ok(emitter.out)
+}
+
+struct Emitter<'a> {
+    func: &'a ir::Function,
+    params: &'a [String],
+    uses: Vec<usize>,
+    structural_uses: Vec<usize>,
+    value_var: Vec<Option<String>>,
+    out: String,
+}
+
+impl<'a> Emitter<'a> {
+    fn new(func: &'a ir::Function, params: &'a [String]) -> Emitter<'a> {
+        let uses = func.uses();
+
+        // Count uses of slices that only select lanes or bits of their own
+        // operand, so the slice itself is never computed: a zero extension
+        // that is a lane shuffle, or a slice of the slice.
+        let mut structural_uses = vec![0; func.nodes.len()];
+        for (i, node) in func.nodes.iter().enumerate() {
+            if uses[i] == 0 {
+                continue;
+            }
+            let structural = match *node {
+                Node::ZeroExtend { x, width } => lane_shuffle(func, x, width).is_some(),
+                Node::Extract { x, .. } => matches!(func.node(x), Node::Extract { .. }),
+                _ => false,
+            };
+            if structural {
+                structural_uses[node.operands()[0].index()] += 1;
+            }
+        }
+
+        Emitter {
+            func,
+            params,
+            uses,
+            structural_uses,
+            value_var: vec![None; func.nodes.len()],
+            out: String::new(),
+        }
+    }
+
+    // C expression for the given value, reading from a variable if available.
+    fn value(&self, value: Value) -> Result<String> {
+        if let Some(var) = &self.value_var[value.index()] {
+            return Ok(var.clone());
+        }
+        self.tree(value)
+    }
+
+    // C expression computing the given value from its operands.
+    fn tree(&self, value: Value) -> Result<String> {
+        let width = self.func.ty(value).width();
+        let expr = match self.func.node(value) {
+            Node::Param { idx } => self.params[idx.index()].clone(),
+            Node::IConst { bits } => match width {
+                8 | 16 => format!("{:#x}", bits.value),
+                32 | 64 => format!("UINT{width}_C({:#x})", bits.value),
+                128 => format!(
+                    "wasm_u64x2_make(UINT64_C({:#x}), UINT64_C({:#x}))",
+                    bits.value as u64,
+                    (bits.value >> 64) as u64
+                ),
+                _ => bail!("unsupported constant width {width}"),
+            },
+            Node::IAdd(x, y) => self.arith("+", width, *x, *y)?,
+            Node::IAnd(x, y) => self.bitwise("&", *x, *y)?,
+            Node::IOr(x, y) => self.bitwise("|", *x, *y)?,
+            Node::IXor(x, y) => self.bitwise("^", *x, *y)?,
+            Node::IRotl(x, s) => match width {
+                8 | 16 | 32 | 64 => format!(
+                    "__builtin_rotateleft{width}({}, {})",
+                    self.value(*x)?,
+                    self.value(*s)?
+                ),
+                _ => bail!("unsupported rotate width {width}"),
+            },
+            Node::Extract { x, low, .. } => self.extract(*x, *low, width)?,
+            Node::Concat { .. } => self.concat(value, width)?,
+            Node::ZeroExtend { x, .. } => self.zero_extend(*x, width)?,
+        };
+        Ok(expr)
+    }
+
+    fn arith(&self, op: &str, width: usize, x: Value, y: Value) -> Result<String> {
+        let (x, y) = (self.value(x)?, self.value(y)?);
+        match width {
+            // Truncate after integer promotion.
+            8 | 16 => Ok(format!("({})({x} {op} {y})", ctype(width)?)),
+            32 | 64 => Ok(format!("({x} {op} {y})")),
+            _ => bail!("unsupported arithmetic width {width}"),
+        }
+    }
+
+    fn bitwise(&self, op: &str, x: Value, y: Value) -> Result<String> {
+        Ok(format!("({} {op} {})", self.value(x)?, self.value(y)?))
+    }
+
+    fn extract(&self, x: Value, low: usize, width: usize) -> Result<String> {
+        // Slice of a slice is a single slice of the original value.
+        if let (Node::Extract { x: y, low: l, .. }, None) =
+            (self.func.node(x), &self.value_var[x.index()])
+        {
+            return self.extract(*y, l + low, width);
+        }
+
+        let xw = self.func.ty(x).width();
+        let expr = self.value(x)?;
+        match xw {
+            128 if low % width == 0 && matches!(width, 8 | 16 | 32 | 64) => Ok(format!(
+                "wasm_u{width}x{}_extract_lane({expr}, {})",
+                128 / width,
+                low / width
+            )),
+            128 => bail!("unsupported extract of {width} bits at {low} from vector"),
+            _ if low == 0 => Ok(format!("({})({expr})", ctype(width)?)),
+            _ => Ok(format!("({})({expr} >> {low})", ctype(width)?)),
+        }
+    }
+
+    fn concat(&self, value: Value, width: usize) -> Result<String> {
+        // Collect the concatenated values, least significant first.
+        let mut leaves = Vec::new();
+        self.concat_leaves(value, true, &mut leaves);
+
+        if width < 128 {
+            return self.join(&leaves, width);
+        }
+
+        // Vectors of equal width lanes.
+        let lw = self.func.ty(leaves[0]).width();
+        if leaves.iter().all(|v| self.func.ty(*v).width() == lw) {
+            let lanes = leaves
+                .iter()
+                .map(|v| self.value(*v))
+                .collect::<Result<Vec<_>>>()?;
+            return Ok(format!(
+                "wasm_u{lw}x{}_make({})",
+                lanes.len(),
+                lanes.join(", ")
+            ));
+        }
+
+        // Otherwise, join leaves of mixed widths into 64-bit lanes.
+        let mut lanes = Vec::new();
+        let mut lane = Vec::new();
+        let mut lane_width = 0;
+        for leaf in leaves {
+            lane.push(leaf);
+            lane_width += self.func.ty(leaf).width();
+            if lane_width > 64 {
+                bail!("unsupported concatenation across 64-bit lanes");
+            }
+            if lane_width == 64 {
+                lanes.push(self.join(&lane, 64)?);
+                lane.clear();
+                lane_width = 0;
+            }
+        }
+        Ok(format!("wasm_u64x2_make({})", lanes.join(", ")))
+    }
+
+    // Scalar concatenation of values, least significant first.
+    fn join(&self, leaves: &[Value], width: usize) -> Result<String> {
+        if let [leaf] = leaves {
+            return self.value(*leaf);
+        }
+
+        let ty = ctype(width)?;
+        let mut shift = 0;
+        let mut terms = Vec::new();
+        for leaf in leaves {
+            let expr = self.value(*leaf)?;
+            terms.push(match shift {
+                0 => format!("({ty})({expr})"),
+                _ => format!("({ty})({expr}) << {shift}"),
+            });
+            shift += self.func.ty(*leaf).width();
+        }
+        Ok(format!("({})", terms.join(" | ")))
+    }
+
+    // Flatten nested concatenations, stopping at values already computed into
+    // a variable.
+    fn concat_leaves(&self, value: Value, root: bool, leaves: &mut Vec<Value>) {
+        match self.func.node(value) {
+            Node::Concat { hi, lo } if root || self.value_var[value.index()].is_none() => {
+                self.concat_leaves(*lo, false, leaves);
+                self.concat_leaves(*hi, false, leaves);
+            }
+            _ => leaves.push(value),
+        }
+    }
+
+    fn zero_extend(&self, x: Value, width: usize) -> Result<String> {
+        let xw = self.func.ty(x).width();
+        if width < 128 {
+            return Ok(format!("({})({})", ctype(width)?, self.value(x)?));
+        }
+        if xw <= 64 {
+            return Ok(format!("wasm_u64x2_make({}, 0)", self.value(x)?));
+        }
+
+        if let Some((y, lanes)) = lane_shuffle(self.func, x, width) {
+            let lanes: Vec<_> = lanes.iter().map(|i| i.to_string()).collect();
+            return Ok(format!(
+                "wasm_i32x4_shuffle({}, wasm_i32x4_splat(0), {})",
+                self.value(y)?,
+                lanes.join(", ")
+            ));
+        }
+
+        bail!("unsupported zero extension from {xw} bits")
+    }
+
+    fn line(&mut self, line: String) {
+        self.out.push_str(&line);
+        self.out.push('\n');
+    }
+}
+
+// Zero extension of a lane-aligned slice of a vector, wider than a scalar, to
+// a vector is a lane shuffle with zeros. Returns the sliced vector and the
+// shuffle lanes, where lane 4 is zero.
+fn lane_shuffle(func: &ir::Function, x: Value, width: usize) -> Option<(Value, [usize; 4])> {
+    let xw = func.ty(x).width();
+    if width != 128 || xw <= 64 || xw % 32 != 0 {
+        return None;
+    }
+    match *func.node(x) {
+        Node::Extract { x: y, low, .. } if low % 32 == 0 && func.ty(y).width() == 128 => Some((
+            y,
+            std::array::from_fn(|i| if i < xw / 32 { low / 32 + i } else { 4 }),
+        )),
+        _ => None,
+    }
+}
+
+fn ctype(width: usize) -> Result<&'static str> {
+    match width {
+        8 => Ok("uint8_t"),
+        16 => Ok("uint16_t"),
+        32 => Ok("uint32_t"),
+        64 => Ok("uint64_t"),
+        128 => Ok("v128_t"),
+        _ => bail!("unsupported c type width {width}"),
+    }
+}
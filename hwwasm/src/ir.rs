@@ -1,6 +1,8 @@
+use std::{collections::HashMap, fmt};
+
 macro_rules! declare_index {
     ($name:ident) => {
-        #[derive(Copy, Clone, Debug)]
+        #[derive(Copy, Clone, Debug, PartialEq, Eq, PartialOrd, Ord, Hash)]
         pub struct $name(pub usize);
 
         impl $name {
@@ -12,13 +14,23 @@ macro_rules! declare_index {
 }
 
 declare_index!(LocalIdx);
+declare_index!(ParamIdx);
+declare_index!(Value);
 
-#[derive(Debug)]
+#[derive(Debug, Clone, PartialEq, Eq, Hash)]
 pub enum Type {
     Int(usize),
 }
 
-#[derive(Debug)]
+impl Type {
+    pub fn width(&self) -> usize {
+        match self {
+            Type::Int(width) => *width,
+        }
+    }
+}
+
+#[derive(Debug, Clone, PartialEq, Eq, Hash)]
 pub struct Bits {
     pub width: usize,
     pub value: u128,
@@ -30,40 +42,153 @@ impl Bits {
     }
 }
 
-#[derive(Debug)]
-pub enum Inst {
-    // Variables
-    LocalGet { idx: LocalIdx },
-    LocalSet { idx: LocalIdx },
+/// Node in the value graph. Operands always refer to values defined earlier in
+/// the function, so the node list is in topological order.
+#[derive(Debug, Clone, PartialEq, Eq, Hash)]
+pub enum Node {
+    // Arguments
+    Param { idx: ParamIdx },
 
     // Numerics
     IConst { bits: Bits },
-    IAdd,
-    IAnd,
-    IXor,
-    IRotl,
+    IAdd(Value, Value),
+    IAnd(Value, Value),
+    IOr(Value, Value),
+    IXor(Value, Value),
+    IRotl(Value, Value),
 
     // Pseudo
-    Extract { low: usize, width: usize },
+    Extract { x: Value, low: usize, width: usize },
+    Concat { hi: Value, lo: Value },
+    ZeroExtend { x: Value, width: usize },
+}
+
+impl Node {
+    pub fn operands(&self) -> Vec<Value> {
+        match self {
+            Node::Param { .. } | Node::IConst { .. } => Vec::new(),
+            Node::IAdd(x, y)
+            | Node::IAnd(x, y)
+            | Node::IOr(x, y)
+            | Node::IXor(x, y)
+            | Node::IRotl(x, y) => vec![*x, *y],
+            Node::Concat { hi, lo } => vec![*hi, *lo],
+            Node::Extract { x, .. } | Node::ZeroExtend { x, .. } => vec![*x],
+        }
+    }
+
+    // Order operands of commutative operations, so that equivalent expressions
+    // hash to the same node.
+    fn canonicalize(self) -> Node {
+        match self {
+            Node::IAdd(x, y) if y < x => Node::IAdd(y, x),
+            Node::IAnd(x, y) if y < x => Node::IAnd(y, x),
+            Node::IOr(x, y) if y < x => Node::IOr(y, x),
+            Node::IXor(x, y) if y < x => Node::IXor(y, x),
+            node => node,
+        }
+    }
 }
 
+/// Function in value graph form. Nodes are hash-consed on insertion, so an
+/// expression that occurs many times in the source semantics is only
+/// represented (and later computed) once.
 #[derive(Debug)]
 pub struct Function {
-    pub locals: Vec<Type>,
-    pub insts: Vec<Inst>,
+    pub params: Vec<Type>,
+    pub nodes: Vec<Node>,
+    pub types: Vec<Type>,
+    pub results: Vec<Value>,
+    dedup: HashMap<Node, Value>,
 }
 
 impl Function {
     pub fn new() -> Function {
         Function {
-            locals: Vec::new(),
-            insts: Vec::new(),
+            params: Vec::new(),
+            nodes: Vec::new(),
+            types: Vec::new(),
+            results: Vec::new(),
+            dedup: HashMap::new(),
+        }
+    }
+
+    pub fn param(&mut self, ty: Type) -> Value {
+        let idx = ParamIdx(self.params.len());
+        self.params.push(ty);
+        self.insert(Node::Param { idx })
+    }
+
+    pub fn result(&mut self, value: Value) {
+        self.results.push(value);
+    }
+
+    /// Insert a node, returning the existing value if an identical node has
+    /// already been inserted.
+    pub fn insert(&mut self, node: Node) -> Value {
+        let node = node.canonicalize();
+        if let Some(value) = self.dedup.get(&node) {
+            return *value;
+        }
+
+        let ty = self.infer(&node);
+        let value = Value(self.nodes.len());
+        self.nodes.push(node.clone());
+        self.types.push(ty);
+        self.dedup.insert(node, value);
+        value
+    }
+
+    pub fn node(&self, value: Value) -> &Node {
+        &self.nodes[value.index()]
+    }
+
+    pub fn ty(&self, value: Value) -> &Type {
+        &self.types[value.index()]
+    }
+
+    fn infer(&self, node: &Node) -> Type {
+        match node {
+            Node::Param { idx } => self.params[idx.index()].clone(),
+            Node::IConst { bits } => Type::Int(bits.width),
+            Node::IAdd(x, _)
+            | Node::IAnd(x, _)
+            | Node::IOr(x, _)
+            | Node::IXor(x, _)
+            | Node::IRotl(x, _) => self.ty(*x).clone(),
+            Node::Extract { width, .. } | Node::ZeroExtend { width, .. } => Type::Int(*width),
+            Node::Concat { hi, lo } => Type::Int(self.ty(*hi).width() + self.ty(*lo).width()),
         }
     }
 
-    pub fn alloc_local(&mut self, ty: Type) -> LocalIdx {
-        let idx = LocalIdx(self.locals.len());
-        self.locals.push(ty);
-        idx
+    /// Count uses of each value reachable from the function results. Dead
+    /// values have zero uses.
+    pub fn uses(&self) -> Vec<usize> {
+        let mut uses = vec![0; self.nodes.len()];
+        for result in &self.results {
+            uses[result.index()] += 1;
+        }
+
+        // Nodes appear after their operands, so a single reverse pass suffices.
+        for (i, node) in self.nodes.iter().enumerate().rev() {
+            if uses[i] == 0 {
+                continue;
+            }
+            for operand in node.operands() {
+                uses[operand.index()] += 1;
+            }
+        }
+
+        uses
+    }
+}
+
+impl fmt::Display for Function {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        for (i, node) in self.nodes.iter().enumerate() {
+            writeln!(f, "v{i}: {:?} = {node:?}", self.types[i])?;
+        }
+        let results: Vec<_> = self.results.iter().map(|v| format!("v{}", v.0)).collect();
+        writeln!(f, "return {}", results.join(", "))
     }
 }
@@ -1,2 +1,4 @@
+pub mod c;
 pub mod ir;
+pub mod lower;
 pub mod translate;
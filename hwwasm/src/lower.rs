@@ -0,0 +1,134 @@
+// Lowering of value graph functions to Wasm local/stack form.
+
+use crate::ir::{self, LocalIdx, Node, Value};
+
+#[derive(Debug)]
+pub enum Inst {
+    // Variables
+    LocalGet { idx: LocalIdx },
+    LocalSet { idx: LocalIdx },
+
+    // Numerics
+    IConst { bits: ir::Bits },
+    IAdd,
+    IAnd,
+    IOr,
+    IXor,
+    IRotl,
+
+    // Pseudo
+    Extract { low: usize, width: usize },
+    Concat,
+    ZeroExtend { width: usize },
+}
+
+/// Function body in Wasm local/stack form. Parameters occupy the first locals,
+/// and results are left on the stack in order.
+#[derive(Debug)]
+pub struct Code {
+    pub locals: Vec<ir::Type>,
+    pub insts: Vec<Inst>,
+}
+
+impl Code {
+    fn alloc_local(&mut self, ty: ir::Type) -> LocalIdx {
+        let idx = LocalIdx(self.locals.len());
+        self.locals.push(ty);
+        idx
+    }
+}
+
+/// Lower a function to local/stack form.
+///
+/// Values that are live and used more than once are computed once into a
+/// local at their definition point. All other values are emitted inline as
+/// expression trees at their single use, and dead values are dropped.
+pub fn lower(func: &ir::Function) -> Code {
+    let mut lowerer = Lowerer::new(func);
+    lowerer.lower();
+    lowerer.code
+}
+
+struct Lowerer<'a> {
+    func: &'a ir::Function,
+    code: Code,
+    uses: Vec<usize>,
+    value_local: Vec<Option<LocalIdx>>,
+}
+
+impl<'a> Lowerer<'a> {
+    fn new(func: &'a ir::Function) -> Lowerer<'a> {
+        Lowerer {
+            func,
+            code: Code {
+                locals: func.params.clone(),
+                insts: Vec::new(),
+            },
+            uses: func.uses(),
+            value_local: vec![None; func.nodes.len()],
+        }
+    }
+
+    fn lower(&mut self) {
+        let func = self.func;
+
+        // Compute shared values into locals, in definition order.
+        for (i, node) in func.nodes.iter().enumerate() {
+            let shared = self.uses[i] > 1;
+            let trivial = matches!(node, Node::Param { .. } | Node::IConst { .. });
+            if !shared || trivial {
+                continue;
+            }
+
+            let value = Value(i);
+            self.tree(value);
+            let idx = self.code.alloc_local(func.ty(value).clone());
+            self.emit(Inst::LocalSet { idx });
+            self.value_local[i] = Some(idx);
+        }
+
+        // Push results.
+        for result in &func.results {
+            self.value(*result);
+        }
+    }
+
+    // Emit code to push the given value, reading from a local if available.
+    fn value(&mut self, value: Value) {
+        if let Some(idx) = self.value_local[value.index()] {
+            self.emit(Inst::LocalGet { idx });
+            return;
+        }
+        self.tree(value);
+    }
+
+    // Emit code to compute the given value from its operands.
+    fn tree(&mut self, value: Value) {
+        let node = self.func.node(value);
+        for operand in node.operands() {
+            self.value(operand);
+        }
+        let inst = match node {
+            Node::Param { idx } => Inst::LocalGet {
+                idx: LocalIdx(idx.index()),
+            },
+            Node::IConst { bits } => Inst::IConst { bits: bits.clone() },
+            Node::IAdd(..) => Inst::IAdd,
+            Node::IAnd(..) => Inst::IAnd,
+            Node::IOr(..) => Inst::IOr,
+            Node::IXor(..) => Inst::IXor,
+            Node::IRotl(..) => Inst::IRotl,
+            Node::Extract { low, width, .. } => Inst::Extract {
+                low: *low,
+                width: *width,
+            },
+            Node::Concat { .. } => Inst::Concat,
+            Node::ZeroExtend { width, .. } => Inst::ZeroExtend { width: *width },
+        };
+        self.emit(inst);
+    }
+
+    fn emit(&mut self, inst: Inst) {
+        self.code.insts.push(inst);
+    }
+}
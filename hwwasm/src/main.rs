@@ -1,7 +1,7 @@
-use anyhow::Result;
+use anyhow::{format_err, Result};
 use clap::Parser as ClapParser;
 use hwwasm::{
-    ir,
+    c, ir, lower,
     translate::{Target, Translator},
 };
 use hwwasm_aslp::parser;
@@ -13,11 +13,35 @@ struct Args {
     /// Input file to be translated.
     file: PathBuf,
 
+    /// Function parameter as <name>:<width>:<target>, for example "wk:128:_Z[1]".
+    #[arg(short = 'p', long = "param")]
+    params: Vec<String>,
+
+    /// Function result as <width>:<target>, for example "128:_Z[5]".
+    #[arg(short = 'r', long = "result")]
+    results: Vec<String>,
+
+    /// Output format.
+    #[arg(long, value_enum, default_value_t = Emit::Wasm)]
+    emit: Emit,
+
+    /// Function name for C output.
+    #[arg(long, default_value = "f")]
+    name: String,
+
     /// Print debugging output (repeat for more detail)
     #[arg(short = 'd', long = "debug", action = clap::ArgAction::Count)]
     debug_level: u8,
 }
 
+#[derive(Clone, clap::ValueEnum)]
+enum Emit {
+    /// Wasm local/stack form.
+    Wasm,
+    /// C function using Wasm SIMD intrinsics.
+    C,
+}
+
 fn main() -> Result<()> {
     let args = Args::parse();
 
@@ -26,23 +50,47 @@ fn main() -> Result<()> {
     let block = parser::parse(&src)?;
 
     // Translate
+    //
+    // For example, for "sha1c q5, s6, v1.4s":
+    //
+    //  --param hash_abcd:128:_Z[5] --param hash_e:32:_Z[6] --param wk:128:_Z[1]
+    //  --result 128:_Z[5]
     let mut translator = Translator::new();
 
-    // sha1c q5, s6, v1.4s
-    //
-    // Args:
-    //  hash_abcd  register: Qd
-    //  hash_e  register: Sn
-    //  wk  register: Vm.4S
-    let z = Target::Var("_Z".to_string());
-    translator.arg(ir::Type::Int(128), Target::Index(Box::new(z.clone()), 5));
-    translator.arg(ir::Type::Int(32), Target::Index(Box::new(z.clone()), 6));
-    translator.arg(ir::Type::Int(128), Target::Index(Box::new(z.clone()), 1));
+    let mut names = Vec::new();
+    for param in &args.params {
+        let (name, rest) = param
+            .split_once(':')
+            .ok_or_else(|| format_err!("invalid parameter: {param:?}"))?;
+        let (ty, target) = parse_typed_target(rest)?;
+        translator.arg(ty, target);
+        names.push(name.to_string());
+    }
 
     translator.translate(&block)?;
 
-    // Print
-    println!("{:#?}", translator.function());
+    for result in &args.results {
+        let (ty, target) = parse_typed_target(result)?;
+        translator.ret(ty, target)?;
+    }
+
+    let func = translator.function();
+    if args.debug_level > 0 {
+        eprint!("{func}");
+    }
+
+    // Emit
+    match args.emit {
+        Emit::Wasm => println!("{:#?}", lower::lower(func)),
+        Emit::C => print!("{}", c::emit(&args.name, &names, func)?),
+    }
 
     Ok(())
 }
+
+fn parse_typed_target(s: &str) -> Result<(ir::Type, Target)> {
+    let (width, target) = s
+        .split_once(':')
+        .ok_or_else(|| format_err!("expected <width>:<target>: {s:?}"))?;
+    Ok((ir::Type::Int(width.parse()?), target.parse()?))
+}
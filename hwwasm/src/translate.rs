@@ -1,6 +1,6 @@
-use std::collections::HashMap;
+use std::{collections::HashMap, str::FromStr};
 
-use crate::ir::{self, Inst};
+use crate::ir::{self, Node};
 use anyhow::{bail, format_err, Result};
 use hwwasm_aslp::ast::{Block, Expr, LExpr, Slice, Stmt, Type};
 
@@ -51,21 +51,40 @@ impl TryFrom<&Expr> for Target {
                 let x = Box::new(x.as_ref().try_into()?);
                 Ok(Target::Field(x, name.clone()))
             }
-            _ => todo!("target expr: {expr:?}"),
+            _ => bail!("unsupported target expression: {expr:?}"),
+        }
+    }
+}
+
+impl FromStr for Target {
+    type Err = anyhow::Error;
+
+    // Parse targets in the form of ASLp register accesses, such as "_Z[5]".
+    fn from_str(s: &str) -> Result<Self> {
+        match s.strip_suffix(']').and_then(|s| s.rsplit_once('[')) {
+            Some((array, index)) => Ok(Target::Index(Box::new(array.parse()?), index.parse()?)),
+            None if !s.is_empty() && s.chars().all(|c| c.is_alphanumeric() || c == '_') => {
+                Ok(Target::Var(s.to_string()))
+            }
+            None => bail!("invalid target: {s:?}"),
         }
     }
 }
 
 struct Scope {
-    target_local: HashMap<Target, ir::LocalIdx>,
+    target_value: HashMap<Target, ir::Value>,
 }
 
 impl Scope {
     fn new() -> Scope {
         Scope {
-            target_local: HashMap::new(),
+            target_value: HashMap::new(),
         }
     }
+
+    fn lookup(&self, target: &Target) -> Option<ir::Value> {
+        self.target_value.get(target).copied()
+    }
 }
 
 pub struct Translator {
@@ -86,9 +105,27 @@ impl Translator {
     }
 
     pub fn arg(&mut self, ty: ir::Type, target: Target) {
-        assert!(self.func.insts.is_empty());
-        let idx = self.func.alloc_local(ty);
-        self.scope.target_local.insert(target, idx);
+        assert_eq!(self.func.nodes.len(), self.func.params.len());
+        let value = self.func.param(ty);
+        self.scope.target_value.insert(target, value);
+    }
+
+    pub fn ret(&mut self, ty: ir::Type, target: Target) -> Result<()> {
+        let value = self
+            .scope
+            .lookup(&target)
+            .ok_or_else(|| format_err!("undefined return: {target:?}"))?;
+
+        // Results may be narrower than the target they are read from, for
+        // example a scalar returned in the low bits of a vector register.
+        let width = ty.width();
+        if width > self.func.ty(value).width() {
+            bail!("return {target:?} narrower than {ty:?}");
+        }
+        let value = self.extract(value, 0, width)?;
+
+        self.func.result(value);
+        Ok(())
     }
 
     pub fn translate(&mut self, block: &Block) -> Result<()> {
@@ -101,31 +138,29 @@ impl Translator {
     fn stmt(&mut self, stmt: &Stmt) -> Result<()> {
         match stmt {
             Stmt::ConstDecl { ty, name, rhs } => {
-                // Allocate variable for the declared constant.
+                // Evaluate and bind the declared constant.
                 let ty = ir::Type::try_from(ty)?;
-                let idx = self.func.alloc_local(ty);
+                let value = self.expr(rhs)?;
+                if *self.func.ty(value) != ty {
+                    bail!("constant {name} declared {ty:?} has value of different type");
+                }
                 self.scope
-                    .target_local
-                    .insert(Target::Var(name.clone()), idx);
-
-                // Evaluate and assign.
-                self.expr(rhs)?;
-                self.emit(Inst::LocalSet { idx });
+                    .target_value
+                    .insert(Target::Var(name.clone()), value);
             }
             //Stmt::VarDecl { ty, name, rhs } => todo!(),
             //Stmt::VarDeclsNoInit { ty, names } => todo!(),
             Stmt::Assign { lhs, rhs } => {
-                // Lookup allocated variable for the LHS.
+                // Assignment must be to a defined variable. Processor state,
+                // such as a result register, may be written without being read.
                 let target = lhs.try_into()?;
-                let idx = *self
-                    .scope
-                    .target_local
-                    .get(&target)
-                    .ok_or_else(|| format_err!("assignment to undefined: {target:?}"))?;
-
-                // Evaluate and assign.
-                self.expr(rhs)?;
-                self.emit(Inst::LocalSet { idx });
+                if matches!(target, Target::Var(..)) && self.scope.lookup(&target).is_none() {
+                    bail!("assignment to undefined: {target:?}");
+                }
+
+                // Evaluate and rebind.
+                let value = self.expr(rhs)?;
+                self.scope.target_value.insert(target, value);
             }
             //Stmt::Assert { cond } => todo!(),
             //Stmt::If {
@@ -134,23 +169,19 @@ impl Translator {
             //    else_block,
             //} => todo!(),
             //Stmt::Call { func, types, args } => todo!(),
-            s => todo!("statement: {s:?}"),
+            s => bail!("unsupported statement: {s:?}"),
         }
         Ok(())
     }
 
-    fn expr(&mut self, expr: &Expr) -> Result<()> {
+    fn expr(&mut self, expr: &Expr) -> Result<ir::Value> {
         match expr {
             Expr::Apply { func, types, args } => self.apply(&func.name, types, args),
             Expr::Var(..) | Expr::ArrayIndex { .. } | Expr::Field { .. } => {
                 let target: Target = expr.try_into()?;
-                let idx = *self
-                    .scope
-                    .target_local
-                    .get(&target)
-                    .ok_or_else(|| format_err!("undefined read: {target:?}"))?;
-                self.emit(Inst::LocalGet { idx });
-                Ok(())
+                self.scope
+                    .lookup(&target)
+                    .ok_or_else(|| format_err!("undefined read: {target:?}"))
             }
             Expr::Slices { x, slices } => {
                 let slice = expect_unary(slices)?;
@@ -158,15 +189,35 @@ impl Translator {
             }
             //Expr::LitInt(_) => todo!(),
             //Expr::LitBits(_) => todo!(),
-            e => todo!("expression: {e:?}"),
+            e => bail!("unsupported expression: {e:?}"),
         }
     }
 
-    fn apply(&mut self, func: &str, types: &[Expr], args: &[Expr]) -> Result<()> {
+    fn apply(&mut self, func: &str, types: &[Expr], args: &[Expr]) -> Result<ir::Value> {
         match func {
-            "add_bits" => self.binary(Inst::IAdd, args),
-            "and_bits" => self.binary(Inst::IAnd, args),
-            "eor_bits" => self.binary(Inst::IXor, args),
+            "add_bits" => self.binary(Node::IAdd, args),
+            "and_bits" => self.binary(Node::IAnd, args),
+            "or_bits" => self.binary(Node::IOr, args),
+            "eor_bits" => self.binary(Node::IXor, args),
+            "append_bits" => {
+                let (hi, lo) = expect_binary(args)?;
+                let hi = self.expr(hi)?;
+                let lo = self.expr(lo)?;
+                Ok(self.func.insert(Node::Concat { hi, lo }))
+            }
+            "ZeroExtend" => {
+                let (x, w) = expect_binary(args)?;
+                let width = expr_lit_int_as_usize(w)?;
+                let x = self.expr(x)?;
+                let xw = self.func.ty(x).width();
+                if width < xw {
+                    bail!("zero extension of {xw} bits to narrower {width} bits");
+                }
+                if width == xw {
+                    return Ok(x);
+                }
+                Ok(self.func.insert(Node::ZeroExtend { x, width }))
+            }
             "rol_bits" => {
                 let (x, s) = expect_binary(args)?;
 
@@ -183,40 +234,66 @@ impl Translator {
                     bail!("shift amount {s} greater than value width {xw}");
                 }
 
-                // Emit the shift operation.
-                self.expr(x)?;
-                self.emit(Inst::IConst {
+                // Build the shift operation.
+                let x = self.expr(x)?;
+                if self.func.ty(x).width() != xw {
+                    bail!("rotate operand is not {xw} bits");
+                }
+                let s = self.func.insert(Node::IConst {
                     bits: ir::Bits::new(xw, s),
                 });
-                self.emit(Inst::IRotl);
-                Ok(())
+                Ok(self.func.insert(Node::IRotl(x, s)))
             }
-            _ => todo!("function: {func:?}"),
+            _ => bail!("unsupported function: {func:?}"),
         }
     }
 
-    fn binary(&mut self, inst: ir::Inst, args: &[Expr]) -> Result<()> {
+    fn binary(
+        &mut self,
+        node: fn(ir::Value, ir::Value) -> Node,
+        args: &[Expr],
+    ) -> Result<ir::Value> {
         let (x, y) = expect_binary(args)?;
-        self.expr(x)?;
-        self.expr(y)?;
-        self.emit(inst);
-        Ok(())
+        let x = self.expr(x)?;
+        let y = self.expr(y)?;
+        let (xw, yw) = (self.func.ty(x).width(), self.func.ty(y).width());
+        if xw != yw {
+            bail!("operand widths differ: {xw} and {yw}");
+        }
+        Ok(self.func.insert(node(x, y)))
     }
 
-    fn slice(&mut self, x: &Expr, slice: &Slice) -> Result<()> {
+    fn slice(&mut self, x: &Expr, slice: &Slice) -> Result<ir::Value> {
         match slice {
             Slice::LowWidth(l, w) => {
                 let low = expr_lit_int_as_usize(l)?;
                 let width = expr_lit_int_as_usize(w)?;
-                self.expr(x)?;
-                self.emit(Inst::Extract { low, width });
+                let x = self.expr(x)?;
+                self.extract(x, low, width)
             }
         }
-        Ok(())
     }
 
-    fn emit(&mut self, inst: Inst) {
-        self.func.insts.push(inst);
+    fn extract(&mut self, x: ir::Value, low: usize, width: usize) -> Result<ir::Value> {
+        let xw = self.func.ty(x).width();
+        if width == 0 || low + width > xw {
+            bail!("slice of {width} bits at {low} out of range of {xw} bits");
+        }
+
+        // Slice of the full value is the identity.
+        if low == 0 && width == xw {
+            return Ok(x);
+        }
+
+        match *self.func.node(x) {
+            // Slice of a slice is a single slice of the original value.
+            Node::Extract { x: y, low: l, .. } => self.extract(y, l + low, width),
+
+            // Low bits of a zero extension are the original value.
+            Node::ZeroExtend { x: y, .. } if low == 0 && width == self.func.ty(y).width() => Ok(y),
+
+            _ => Ok(self.func.insert(Node::Extract { x, low, width })),
+        }
     }
 }
 
@@ -226,7 +303,7 @@ impl TryFrom<&Type> for ir::Type {
     fn try_from(ty: &Type) -> Result<Self, Self::Error> {
         match ty {
             Type::Bits(width) => Ok(ir::Type::Int(expr_lit_int_as_usize(width)?)),
-            _ => todo!("type: {ty:?}"),
+            _ => bail!("unsupported type: {ty:?}"),
         }
     }
 }
@@ -0,0 +1,268 @@
+use std::fs;
+
+use hwwasm::{
+    c,
+    ir::{Bits, Function, Node, Type},
+    translate::Translator,
+};
+use hwwasm_aslp::parser;
+
+#[test]
+fn emit_lanes() {
+    let mut func = Function::new();
+    let x = func.param(Type::Int(128));
+
+    // Rotate each 32-bit lane of x left by one.
+    let one = func.insert(Node::IConst {
+        bits: Bits::new(32, 1),
+    });
+    let lanes: Vec<_> = (0..4)
+        .map(|i| {
+            let lane = func.insert(Node::Extract {
+                x,
+                low: 32 * i,
+                width: 32,
+            });
+            func.insert(Node::IRotl(lane, one))
+        })
+        .collect();
+    let lo = func.insert(Node::Concat {
+        hi: lanes[1],
+        lo: lanes[0],
+    });
+    let hi = func.insert(Node::Concat {
+        hi: lanes[3],
+        lo: lanes[2],
+    });
+    let r = func.insert(Node::Concat { hi, lo });
+    func.result(r);
+
+    let src = c::emit("rotl1", &["x".to_string()], &func).unwrap();
+    assert_eq!(
+        src,
+        "v128_t rotl1(v128_t x) {\n    return wasm_u32x4_make(\
+         __builtin_rotateleft32(wasm_u32x4_extract_lane(x, 0), UINT32_C(0x1)), \
+         __builtin_rotateleft32(wasm_u32x4_extract_lane(x, 1), UINT32_C(0x1)), \
+         __builtin_rotateleft32(wasm_u32x4_extract_lane(x, 2), UINT32_C(0x1)), \
+         __builtin_rotateleft32(wasm_u32x4_extract_lane(x, 3), UINT32_C(0x1)));\n}\n"
+    );
+}
+
+// Translate ASLT test data to C, with parameters as (name, width, target) and
+// the result as (width, target).
+fn translate_c(
+    file: &str,
+    name: &str,
+    params: &[(&str, usize, &str)],
+    result: (usize, &str),
+) -> String {
+    let path = format!("{}/aslp/tests/data/{file}.aslt", env!("CARGO_MANIFEST_DIR"));
+    let block = parser::parse(&fs::read_to_string(path).unwrap()).unwrap();
+
+    let mut translator = Translator::new();
+    let mut names = Vec::new();
+    for (param, width, target) in params {
+        translator.arg(Type::Int(*width), target.parse().unwrap());
+        names.push(param.to_string());
+    }
+    translator.translate(&block).unwrap();
+    let (width, target) = result;
+    translator
+        .ret(Type::Int(width), target.parse().unwrap())
+        .unwrap();
+
+    c::emit(name, &names, translator.function()).unwrap()
+}
+
+#[test]
+fn emit_sha1c() {
+    let src = translate_c(
+        "sha1c",
+        "__intrinsic_vsha1cq_u32",
+        &[
+            ("hash_abcd", 128, "_Z[5]"),
+            ("hash_e", 128, "_Z[6]"),
+            ("wk", 128, "_Z[1]"),
+        ],
+        (128, "_Z[5]"),
+    );
+    assert_eq!(
+        src.lines().collect::<Vec<_>>(),
+        [
+            "v128_t __intrinsic_vsha1cq_u32(v128_t hash_abcd, v128_t hash_e, v128_t wk) {",
+            "    const uint32_t v3 = wasm_u32x4_extract_lane(hash_abcd, 0);",
+            "    const uint32_t v6 = wasm_u32x4_extract_lane(hash_abcd, 2);",
+            "    const uint32_t v7 = wasm_u32x4_extract_lane(hash_abcd, 3);",
+            "    const uint32_t v9 = wasm_u32x4_extract_lane(hash_abcd, 1);",
+            "    const uint32_t v11 = __builtin_rotateleft32(v9, UINT32_C(0x1e));",
+            "    const uint32_t v12 = __builtin_rotateleft32(v3, UINT32_C(0x1e));",
+            "    const uint32_t v19 = (((__builtin_rotateleft32(v3, UINT32_C(0x5)) + wasm_u32x4_extract_lane(hash_e, 0)) + (v7 ^ ((v6 ^ v7) & v9))) + wasm_u32x4_extract_lane(wk, 0));",
+            "    const uint32_t v27 = (((v7 + __builtin_rotateleft32(v19, UINT32_C(0x5))) + (v6 ^ (v3 & (v6 ^ v11)))) + wasm_u32x4_extract_lane(wk, 1));",
+            "    const uint32_t v29 = __builtin_rotateleft32(v19, UINT32_C(0x1e));",
+            "    const uint32_t v37 = (((v6 + __builtin_rotateleft32(v27, UINT32_C(0x5))) + (v11 ^ (v19 & (v11 ^ v12)))) + wasm_u32x4_extract_lane(wk, 2));",
+            "    return wasm_u32x4_make((((v11 + __builtin_rotateleft32(v37, UINT32_C(0x5))) + (v12 ^ (v27 & (v12 ^ v29)))) + wasm_u32x4_extract_lane(wk, 3)), v37, __builtin_rotateleft32(v27, UINT32_C(0x1e)), v29);",
+            "}",
+        ]
+    );
+}
+
+#[test]
+fn emit_sha1h() {
+    let src = translate_c(
+        "sha1h",
+        "__intrinsic_vsha1h_u32",
+        &[("hash_e", 128, "_Z[6]")],
+        (128, "_Z[17]"),
+    );
+    assert_eq!(
+        src.lines().collect::<Vec<_>>(),
+        [
+            "v128_t __intrinsic_vsha1h_u32(v128_t hash_e) {",
+            "    return wasm_u64x2_make(__builtin_rotateleft32(wasm_u32x4_extract_lane(hash_e, 0), UINT32_C(0x1e)), 0);",
+            "}",
+        ]
+    );
+}
+
+#[test]
+fn emit_sha1su0() {
+    let src = translate_c(
+        "sha1su0",
+        "__intrinsic_vsha1su0q_u32",
+        &[
+            ("w0_3", 128, "_Z[3]"),
+            ("w4_7", 128, "_Z[0]"),
+            ("w8_11", 128, "_Z[1]"),
+        ],
+        (128, "_Z[3]"),
+    );
+    assert_eq!(
+        src.lines().collect::<Vec<_>>(),
+        [
+            "v128_t __intrinsic_vsha1su0q_u32(v128_t w0_3, v128_t w4_7, v128_t w8_11) {",
+            "    return (w8_11 ^ (w0_3 ^ wasm_u64x2_make(wasm_u64x2_extract_lane(w0_3, 1), wasm_u64x2_extract_lane(w4_7, 0))));",
+            "}",
+        ]
+    );
+}
+
+#[test]
+fn emit_sha1su1() {
+    let src = translate_c(
+        "sha1su1",
+        "__intrinsic_vsha1su1q_u32",
+        &[("tw0_3", 128, "_Z[2]"), ("w12_15", 128, "_Z[1]")],
+        (128, "_Z[2]"),
+    );
+    assert_eq!(
+        src.lines().collect::<Vec<_>>(),
+        [
+            "v128_t __intrinsic_vsha1su1q_u32(v128_t tw0_3, v128_t w12_15) {",
+            "    const v128_t v4 = (tw0_3 ^ wasm_i32x4_shuffle(w12_15, wasm_i32x4_splat(0), 1, 2, 3, 4));",
+            "    const uint32_t v8 = wasm_u32x4_extract_lane(v4, 0);",
+            "    return wasm_u32x4_make(__builtin_rotateleft32(v8, UINT32_C(0x1)), __builtin_rotateleft32(wasm_u32x4_extract_lane(v4, 1), UINT32_C(0x1)), __builtin_rotateleft32(wasm_u32x4_extract_lane(v4, 2), UINT32_C(0x1)), (__builtin_rotateleft32(wasm_u32x4_extract_lane(v4, 3), UINT32_C(0x1)) ^ __builtin_rotateleft32(v8, UINT32_C(0x2))));",
+            "}",
+        ]
+    );
+}
+
+#[test]
+fn emit_or_bits() {
+    // Majority of the low lanes of two registers, as in SHA1M.
+    let src = r#"Stmt_Assign(LExpr_Array(LExpr_Var("_Z"),0),Expr_TApply("ZeroExtend.0",[32;128],[Expr_TApply("or_bits.0",[32],[Expr_TApply("and_bits.0",[32],[Expr_Slices(Expr_Array(Expr_Var("_Z"),1),[Slice_LoWd(0,32)]);Expr_Slices(Expr_Array(Expr_Var("_Z"),2),[Slice_LoWd(0,32)])]);Expr_TApply("and_bits.0",[32],[Expr_TApply("or_bits.0",[32],[Expr_Slices(Expr_Array(Expr_Var("_Z"),2),[Slice_LoWd(0,32)]);Expr_Slices(Expr_Array(Expr_Var("_Z"),1),[Slice_LoWd(0,32)])]);Expr_Slices(Expr_Array(Expr_Var("_Z"),1),[Slice_LoWd(32,32)])])]);128]))"#;
+    let block = parser::parse(src).unwrap();
+    let mut translator = Translator::new();
+    translator.arg(Type::Int(128), "_Z[1]".parse().unwrap());
+    translator.arg(Type::Int(128), "_Z[2]".parse().unwrap());
+    translator.translate(&block).unwrap();
+    translator
+        .ret(Type::Int(32), "_Z[0]".parse().unwrap())
+        .unwrap();
+
+    let params = ["x".to_string(), "y".to_string()];
+    let src = c::emit("maj", &params, translator.function()).unwrap();
+    assert_eq!(
+        src.lines().collect::<Vec<_>>(),
+        [
+            "uint32_t maj(v128_t x, v128_t y) {",
+            "    const uint32_t v2 = wasm_u32x4_extract_lane(x, 0);",
+            "    const uint32_t v3 = wasm_u32x4_extract_lane(y, 0);",
+            "    return ((v2 & v3) | ((v2 | v3) & wasm_u32x4_extract_lane(x, 1)));",
+            "}",
+        ]
+    );
+}
+
+#[test]
+fn emit_shared_concat() {
+    let mut func = Function::new();
+    let x = func.param(Type::Int(128));
+    let lanes: Vec<_> = (0..4)
+        .map(|i| {
+            func.insert(Node::Extract {
+                x,
+                low: 32 * i,
+                width: 32,
+            })
+        })
+        .collect();
+
+    // The low half is used twice, once within a wider concatenation that must
+    // read it from its variable rather than recompute it.
+    let lo = func.insert(Node::Concat {
+        hi: lanes[1],
+        lo: lanes[0],
+    });
+    let hi = func.insert(Node::Concat {
+        hi: lanes[3],
+        lo: lanes[2],
+    });
+    let v = func.insert(Node::Concat { hi, lo });
+    let w = func.insert(Node::ZeroExtend { x: lo, width: 128 });
+    let r = func.insert(Node::IXor(v, w));
+    func.result(r);
+
+    let src = c::emit("f", &["x".to_string()], &func).unwrap();
+    assert_eq!(
+        src.lines().collect::<Vec<_>>(),
+        [
+            "v128_t f(v128_t x) {",
+            "    const uint64_t v5 = ((uint64_t)(wasm_u32x4_extract_lane(x, 0)) | (uint64_t)(wasm_u32x4_extract_lane(x, 1)) << 32);",
+            "    return (wasm_u64x2_make(v5, ((uint64_t)(wasm_u32x4_extract_lane(x, 2)) | (uint64_t)(wasm_u32x4_extract_lane(x, 3)) << 32)) ^ wasm_u64x2_make(v5, 0));",
+            "}",
+        ]
+    );
+}
+
+#[test]
+fn emit_shared_slice_not_computed() {
+    let mut func = Function::new();
+    let x = func.param(Type::Int(128));
+
+    // The high 96 bits are used twice, but only as lanes of x, so no variable
+    // is needed for a value that has no C type.
+    let e = func.insert(Node::Extract {
+        x,
+        low: 32,
+        width: 96,
+    });
+    let z = func.insert(Node::ZeroExtend { x: e, width: 128 });
+    let l = func.insert(Node::Extract {
+        x: e,
+        low: 32,
+        width: 32,
+    });
+    let w = func.insert(Node::ZeroExtend { x: l, width: 128 });
+    let r = func.insert(Node::IXor(z, w));
+    func.result(r);
+
+    let src = c::emit("f", &["x".to_string()], &func).unwrap();
+    assert_eq!(
+        src.lines().collect::<Vec<_>>(),
+        [
+            "v128_t f(v128_t x) {",
+            "    return (wasm_i32x4_shuffle(x, wasm_i32x4_splat(0), 1, 2, 3, 4) ^ wasm_u64x2_make(wasm_u32x4_extract_lane(x, 2), 0));",
+            "}",
+        ]
+    );
+}
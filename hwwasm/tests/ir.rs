@@ -0,0 +1,172 @@
+use std::fs;
+
+use hwwasm::{
+    ir::{Bits, Function, Node, Type},
+    lower::{lower, Inst},
+    translate::Translator,
+};
+use hwwasm_aslp::parser;
+
+#[test]
+fn hash_cons_identical_nodes() {
+    let mut func = Function::new();
+    let x = func.param(Type::Int(128));
+
+    let a = func.insert(Node::Extract {
+        x,
+        low: 0,
+        width: 8,
+    });
+    let b = func.insert(Node::Extract {
+        x,
+        low: 0,
+        width: 8,
+    });
+    assert_eq!(a, b);
+
+    // Commutative operands are canonicalized.
+    let c = func.insert(Node::Extract {
+        x,
+        low: 8,
+        width: 8,
+    });
+    assert_eq!(func.insert(Node::IXor(a, c)), func.insert(Node::IXor(c, a)));
+
+    // Non-commutative operands are not.
+    let s = func.insert(Node::IConst {
+        bits: Bits::new(8, 1),
+    });
+    assert_ne!(
+        func.insert(Node::IRotl(a, s)),
+        func.insert(Node::IRotl(s, a))
+    );
+}
+
+#[test]
+fn lower_shared_value_to_local() {
+    let mut func = Function::new();
+    let x = func.param(Type::Int(32));
+    let y = func.param(Type::Int(32));
+
+    // (x + y) ^ (y + x): the sum is computed once.
+    let s1 = func.insert(Node::IAdd(x, y));
+    let s2 = func.insert(Node::IAdd(y, x));
+    let r = func.insert(Node::IXor(s1, s2));
+    func.insert(Node::IAnd(x, r)); // dead
+    func.result(r);
+
+    let code = lower(&func);
+    assert_eq!(code.locals, vec![Type::Int(32); 3]);
+
+    let adds = code
+        .insts
+        .iter()
+        .filter(|i| matches!(i, Inst::IAdd))
+        .count();
+    assert_eq!(adds, 1);
+    let ands = code
+        .insts
+        .iter()
+        .filter(|i| matches!(i, Inst::IAnd))
+        .count();
+    assert_eq!(ands, 0);
+    assert!(matches!(
+        code.insts.as_slice(),
+        [
+            Inst::LocalGet { .. },
+            Inst::LocalGet { .. },
+            Inst::IAdd,
+            Inst::LocalSet { .. },
+            Inst::LocalGet { .. },
+            Inst::LocalGet { .. },
+            Inst::IXor,
+        ]
+    ));
+}
+
+#[test]
+fn translate_sha1c_computes_shared_expressions_once() {
+    let src = fs::read_to_string(concat!(
+        env!("CARGO_MANIFEST_DIR"),
+        "/aslp/tests/data/sha1c.aslt"
+    ))
+    .unwrap();
+    let block = parser::parse(&src).unwrap();
+
+    let mut translator = Translator::new();
+    translator.arg(Type::Int(128), "_Z[5]".parse().unwrap());
+    translator.arg(Type::Int(32), "_Z[6]".parse().unwrap());
+    translator.arg(Type::Int(128), "_Z[1]".parse().unwrap());
+    translator.translate(&block).unwrap();
+    translator
+        .ret(Type::Int(128), "_Z[5]".parse().unwrap())
+        .unwrap();
+    let func = translator.function();
+
+    // rol_bits(_Z[5][0:32], 5) occurs both as a Cse variable and inline in
+    // several other expressions, but is a single node.
+    let a = func
+        .nodes
+        .iter()
+        .position(|node| {
+            matches!(node, Node::Extract { x, low: 0, width: 32 }
+                if matches!(func.node(*x), Node::Param { idx } if idx.index() == 0))
+        })
+        .unwrap();
+    let rol_a_5 = func
+        .nodes
+        .iter()
+        .filter(|node| {
+            matches!(node, Node::IRotl(x, s)
+                if x.index() == a
+                    && matches!(func.node(*s), Node::IConst { bits } if bits.value == 5))
+        })
+        .count();
+    assert_eq!(rol_a_5, 1);
+
+    // Lowering computes each shared value once, so it is smaller than
+    // expanding every use as a separate expression tree.
+    let mut tree = vec![0; func.nodes.len()];
+    for (i, node) in func.nodes.iter().enumerate() {
+        tree[i] = 1 + node
+            .operands()
+            .iter()
+            .map(|v| tree[v.index()])
+            .sum::<usize>();
+    }
+    let tree_insts: usize = func.results.iter().map(|v| tree[v.index()]).sum();
+    let code = lower(func);
+    assert!(
+        code.insts.len() < tree_insts,
+        "lowered {} instructions, tree-per-use {tree_insts}",
+        code.insts.len()
+    );
+}
+
+#[test]
+fn translate_rejects_invalid_widths() {
+    let cases = [
+        // Operands of different widths.
+        r#"Stmt_Assign(LExpr_Array(LExpr_Var("_Z"),0),Expr_TApply("add_bits.0",[32],[Expr_Slices(Expr_Array(Expr_Var("_Z"),1),[Slice_LoWd(0,32)]);Expr_Slices(Expr_Array(Expr_Var("_Z"),1),[Slice_LoWd(0,64)])]))"#,
+        // Slice beyond the source width.
+        r#"Stmt_Assign(LExpr_Array(LExpr_Var("_Z"),0),Expr_Slices(Expr_Array(Expr_Var("_Z"),1),[Slice_LoWd(96,64)]))"#,
+        // Zero extension to a narrower width.
+        r#"Stmt_Assign(LExpr_Array(LExpr_Var("_Z"),0),Expr_TApply("ZeroExtend.0",[128;64],[Expr_Array(Expr_Var("_Z"),1);64]))"#,
+    ];
+    for src in cases {
+        let block = parser::parse(src).unwrap();
+        let mut translator = Translator::new();
+        translator.arg(Type::Int(128), "_Z[1]".parse().unwrap());
+        assert!(translator.translate(&block).is_err(), "{src}");
+    }
+}
+
+#[test]
+fn translate_unsupported_is_error() {
+    let src = r#"Stmt_Assign(LExpr_Array(LExpr_Var("_Z"),0),Expr_TApply("mul_bits.0",[128],[Expr_Array(Expr_Var("_Z"),1);Expr_Array(Expr_Var("_Z"),1)]))"#;
+    let block = parser::parse(src).unwrap();
+    let mut translator = Translator::new();
+    translator.arg(Type::Int(128), "_Z[1]".parse().unwrap());
+    let err = translator.translate(&block).unwrap_err();
+    assert!(err.to_string().contains("unsupported function"), "{err}");
+}
@@ -1,7 +1,32 @@
 #!/usr/bin/env python3
+"""
+Generate the Wasm ARM intrinsics C API from the ARM intrinsics database.
 
-import os
+Each selected intrinsic is emitted in one of three forms, in order of
+preference:
+
+* Direct: a static inline function implemented with existing Wasm SIMD
+  operators, for example vaddq_u32 as wasm_i32x4_add.
+* Engine: an __intrinsic_* declaration over v128 values, which an engine may
+  compile directly to the corresponding instruction, and a static inline
+  wrapper adapting it to the C API. The fallback definition of the
+  __intrinsic_* function goes in the source file, unless it is hand-written
+  (see HANDWRITTEN_FALLBACKS).
+* Fallback: a static inline __intrinsic_* function and C API wrapper.
+
+Both fallback forms are generated from instruction semantics: the instruction
+is assembled, lifted to ASLT by ASLp (asli), and translated to C by hwwasm.
+This requires clang, llvm-objdump, asli and a build of hwwasm.
+"""
+
+import argparse
+import fnmatch
 import json
+import os
+import re
+import subprocess
+import sys
+import tempfile
 
 
 ENABLED_INTRINSICS = {
@@ -21,6 +46,30 @@ ENABLED_INTRINSICS = {
     "vsha1su1q_u32",
 }
 
+# Intrinsics with engine support: these are declared as external
+# __intrinsic_* functions for the engine to recognize.
+ENGINE_INTRINSICS = {
+    "vsha1cq_u32",
+    "vsha1h_u32",
+    "vsha1mq_u32",
+    "vsha1pq_u32",
+    "vsha1su0q_u32",
+    "vsha1su1q_u32",
+}
+
+# Engine intrinsics whose fallback definitions are hand-written rather than
+# generated, in example/sha1/wasm_arm_neon_fallback.c. Only the declaration and
+# wrapper are generated for these.
+HANDWRITTEN_FALLBACKS = {
+    "vsha1mq_u32",
+    "vsha1pq_u32",
+}
+
+# Architecture used to assemble instructions for semantics.
+ASM_MARCH = "armv8.2-a+crypto+sha3+sm4"
+
+REPO_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
 
 def data_path(name):
     return os.path.join(os.getenv("HWWASM_DATA_DIR"), name)
@@ -31,28 +80,466 @@ def read_intrinsics_database():
         return json.load(f)
 
 
-def generate_c_header_declarations(intrinsics):
+class Unsupported(Exception):
+    pass
+
+
+# Types
+
+
+SCALAR_TYPE_RE = re.compile(r"(u?int)(8|16|32|64)_t")
+VECTOR_TYPE_RE = re.compile(r"(u?int|float|poly)(8|16|32|64)x(\d+)_t")
+
+
+def parse_arg(arg):
+    """Split a C parameter declaration into type and name."""
+    *ty, name = arg.replace("*", " * ").split()
+    return " ".join(ty), name
+
+
+def vector_type(ty):
+    """Return (kind, lane width, lanes) for a 128-bit vector type, else None."""
+    m = VECTOR_TYPE_RE.fullmatch(ty)
+    if not m:
+        return None
+    kind, width, lanes = m.group(1), int(m.group(2)), int(m.group(3))
+    if width * lanes != 128:
+        raise Unsupported(f"{width * lanes}-bit vector type {ty}")
+    return kind, width, lanes
+
+
+def scalar_width(ty):
+    m = SCALAR_TYPE_RE.fullmatch(ty.replace("const ", ""))
+    if not m:
+        raise Unsupported(f"scalar type {ty}")
+    return int(m.group(2))
+
+
+def value_width(ty):
+    if vector_type(ty):
+        return 128
+    return scalar_width(ty)
+
+
+# Direct mappings
+
+
+def sign_of(kind):
+    return "u" if kind == "uint" else "i"
+
+
+def direct_binary(op, sign=lambda kind: "i"):
+    def body(v, args):
+        kind, width, lanes = v
+        return f"return wasm_{sign(kind)}{width}x{lanes}_{op}({args[0]}, {args[1]});"
+
+    return body
+
+
+def direct_bitwise(op):
+    return lambda v, args: f"return wasm_v128_{op}({', '.join(args)});"
+
+
+def direct_rev(v, args, group_bits):
+    _, width, _ = v
+    lanes_per_group = group_bits // width
+    bytes_per_lane = width // 8
+    indices = []
+    for group in range(128 // group_bits):
+        for lane in reversed(range(lanes_per_group)):
+            base = (group * lanes_per_group + lane) * bytes_per_lane
+            indices.extend(range(base, base + bytes_per_lane))
+    return (
+        f"return wasm_i8x16_shuffle({args[0]}, wasm_i8x16_splat(0), "
+        f"{', '.join(map(str, indices))});"
+    )
+
+
+def direct_shr(v, args):
+    # ARM allows shifting by the full lane width, but Wasm takes the shift
+    # count modulo the lane width.
+    kind, width, lanes = v
+    x, n = args
+    if kind == "uint":
+        return (
+            f"return {n} == {width} ? wasm_i{width}x{lanes}_splat(0) "
+            f": wasm_u{width}x{lanes}_shr({x}, {n});"
+        )
+    return f"return wasm_i{width}x{lanes}_shr({x}, {n} == {width} ? {width - 1} : {n});"
+
+
+def direct_get_lane(v, args):
+    kind, width, lanes = v
+    sign = sign_of(kind)
+    lines = [f"switch ({args[1]}) {{"]
+    for lane in range(lanes):
+        lines.append(f"    case {lane}:")
+        lines.append(f"        return wasm_{sign}{width}x{lanes}_extract_lane({args[0]}, {lane});")
+    lines.append("    default:")
+    lines.append("        __builtin_unreachable();")
+    lines.append("}")
+    return "\n".join(lines)
+
+
+# Rules mapping intrinsic names to direct implementations. Each body function
+# receives the vector type of the intrinsic and the argument names.
+DIRECT_RULES = [
+    (r"vaddq_[su](8|16|32|64)", direct_binary("add")),
+    (r"vsubq_[su](8|16|32|64)", direct_binary("sub")),
+    (r"vmulq_[su](16|32)", direct_binary("mul")),
+    (r"vqaddq_[su](8|16)", direct_binary("add_sat", sign_of)),
+    (r"vqsubq_[su](8|16)", direct_binary("sub_sat", sign_of)),
+    (r"vmaxq_[su](8|16|32)", direct_binary("max", sign_of)),
+    (r"vminq_[su](8|16|32)", direct_binary("min", sign_of)),
+    (r"vandq_[su](8|16|32|64)", direct_bitwise("and")),
+    (r"vorrq_[su](8|16|32|64)", direct_bitwise("or")),
+    (r"veorq_[su](8|16|32|64)", direct_bitwise("xor")),
+    (r"vbicq_[su](8|16|32|64)", direct_bitwise("andnot")),
+    (r"vmvnq_[su](8|16|32)", direct_bitwise("not")),
+    (
+        r"vdupq_n_[su](8|16|32|64)",
+        lambda v, args: f"return wasm_{sign_of(v[0])}{v[1]}x{v[2]}_splat({args[0]});",
+    ),
+    (
+        r"vshlq_n_[su](8|16|32|64)",
+        lambda v, args: f"return wasm_i{v[1]}x{v[2]}_shl({args[0]}, {args[1]});",
+    ),
+    (r"vshrq_n_[su](8|16|32|64)", direct_shr),
+    (r"vld1q_[su](8|16|32|64)", lambda v, args: f"return wasm_v128_load({args[0]});"),
+    (r"vst1q_[su](8|16|32|64)", lambda v, args: f"wasm_v128_store({args[0]}, {args[1]});"),
+    (r"vgetq_lane_[su](8|16|32|64)", direct_get_lane),
+    (r"vrev16q_[su]8", lambda v, args: direct_rev(v, args, 16)),
+    (r"vrev32q_[su](8|16)", lambda v, args: direct_rev(v, args, 32)),
+    (r"vrev64q_[su](8|16|32)", lambda v, args: direct_rev(v, args, 64)),
+]
+
+
+def intrinsic_vector_type(intrinsic):
+    """Vector type that determines lane shape: the first vector argument or
+    result type."""
+    types = [parse_arg(arg)[0] for arg in intrinsic["arguments"]]
+    types.append(intrinsic["return_type"]["value"])
+    for ty in types:
+        v = vector_type(ty.replace("const ", "").rstrip(" *"))
+        if v:
+            return v
+    raise Unsupported("no vector type")
+
+
+def direct_reinterpret(intrinsic):
+    """Reinterpretation is free between vector types, which are all v128_t.
+    Other types, such as poly128_t and bfloat16x8_t, have no typedef."""
+    (arg,) = intrinsic["arguments"]
+    ty, name = parse_arg(arg)
+    for t in (ty, intrinsic["return_type"]["value"]):
+        if not vector_type(t):
+            raise Unsupported(f"reinterpret of type {t}")
+    return f"return {name};"
+
+
+def direct_body(intrinsic):
+    if re.fullmatch(r"vreinterpretq_\w+", intrinsic["name"]):
+        return direct_reinterpret(intrinsic)
+    for pattern, body in DIRECT_RULES:
+        if re.fullmatch(pattern, intrinsic["name"]):
+            v = intrinsic_vector_type(intrinsic)
+            args = [parse_arg(arg)[1] for arg in intrinsic["arguments"]]
+            return body(v, args)
+    return None
+
+
+# Semantics
+
+
+REGISTER_RE = re.compile(r"\b([BHSDQVWX])([a-z]\w*)")
+
+
+def register_number(registers, name):
+    return registers.setdefault(name, len(registers))
+
+
+def register_target(register, registers):
+    """Map a database register operand such as "Vm.4S" to an ASLp target."""
+    m = REGISTER_RE.match(register)
+    if not m:
+        raise Unsupported(f"register operand {register}")
+    cls, name = m.group(1), m.group(2)
+    array = "_R" if cls in "WX" else "_Z"
+    return f"{array}[{register_number(registers, name)}]"
+
+
+def instruction(intrinsic):
+    """Return the assembly for the single instruction implementing the
+    intrinsic, and the register numbering used."""
+    sequences = intrinsic.get("instructions", [])
+    if len(sequences) != 1 or len(sequences[0]["list"]) != 1:
+        raise Unsupported("not a single instruction")
+    inst = sequences[0]["list"][0]
+    operands = inst["operands"]
+    if "#" in operands:
+        raise Unsupported("immediate operands")
+
+    registers = {}
+
+    def substitute(m):
+        number = register_number(registers, m.group(2))
+        return f"{m.group(1)}{number}"
+
+    operands = REGISTER_RE.sub(substitute, operands)
+    asm = f"{inst['base_instruction']} {operands}".lower()
+    return asm, registers
+
+
+def assemble(asm):
+    """Assemble a single AArch64 instruction to its 32-bit hex opcode."""
+    obj = subprocess.run(
+        [
+            "clang",
+            "-x",
+            "assembler",
+            "--target=aarch64",
+            f"-march={ASM_MARCH}",
+            "-",
+            "-c",
+            "-o",
+            "/dev/stdout",
+        ],
+        input=asm.encode(),
+        capture_output=True,
+        check=True,
+    ).stdout
+    dump = subprocess.run(
+        ["llvm-objdump", "-", "-d", "--section=.text"],
+        input=obj,
+        capture_output=True,
+        check=True,
+    ).stdout.decode()
+    for line in dump.splitlines():
+        fields = line.split()
+        if fields and fields[0] == "0:":
+            return fields[1]
+    raise Unsupported(f"could not assemble {asm!r}")
+
+
+def semantics(opcode):
+    """Lift an opcode to ASLT with ASLp."""
+    commands = "\n".join(
+        [
+            ':set impdef "Has SHA1 Crypto instructions" = TRUE',
+            ':set impdef "Has SHA256 Crypto instructions" = TRUE',
+            f":ast A64 0x{opcode}",
+        ]
+    )
+    return subprocess.run(
+        ["asli"], input=commands.encode(), capture_output=True, check=True
+    ).stdout.decode()
+
+
+def translate(hwwasm, aslt, name, params, result):
+    """Translate ASLT semantics to a C function definition with hwwasm."""
+    with tempfile.NamedTemporaryFile("w", suffix=".aslt") as f:
+        f.write(aslt)
+        f.flush()
+        cmd = [hwwasm, "--emit", "c", "--name", name, "--result", result]
+        for param in params:
+            cmd.extend(["--param", param])
+        cmd.append(f.name)
+        proc = subprocess.run(cmd, capture_output=True)
+    if proc.returncode != 0:
+        raise Unsupported(f"translation failed: {proc.stderr.decode().strip()}")
+    return proc.stdout.decode()
+
+
+def fallback_definition(hwwasm, intrinsic, vector_params):
+    """Generate the __intrinsic_* definition from instruction semantics. If
+    vector_params is set, all register parameters and results are passed as
+    full 128-bit vectors, as for engine intrinsics."""
+    asm, registers = instruction(intrinsic)
+    aslt = semantics(assemble(asm))
+
+    preparation = intrinsic.get("Arguments_Preparation") or {}
+    params = []
+    for arg in intrinsic["arguments"]:
+        ty, name = parse_arg(arg)
+        if name not in preparation:
+            raise Unsupported(f"argument {name} has no register")
+        target = register_target(preparation[name]["register"], registers)
+        width = 128 if vector_params and target.startswith("_Z") else value_width(ty)
+        params.append(f"{name}:{width}:{target}")
+
+    ret = intrinsic["return_type"]["value"]
+    if ret == "void":
+        raise Unsupported("no result")
+    results = intrinsic.get("results") or []
+    if len(results) != 1:
+        raise Unsupported("expected single result register")
+    target = register_target(next(iter(results[0])), registers)
+    width = 128 if vector_params and target.startswith("_Z") else value_width(ret)
+    result = f"{width}:{target}"
+
+    return translate(hwwasm, aslt, f"__intrinsic_{intrinsic['name']}", params, result)
+
+
+# Generation
+
+
+class Output:
+    def __init__(self):
+        self.lines = []
+
+    def line(self, line=""):
+        self.lines.append(line)
+
+    def block(self, text):
+        for line in text.rstrip("\n").split("\n"):
+            self.line(line)
+
+    def text(self):
+        return "\n".join(self.lines) + "\n"
+
+
+def signature(intrinsic, name=None):
+    params = ", ".join(intrinsic["arguments"])
+    ret = intrinsic["return_type"]["value"]
+    return f"{ret} {name or intrinsic['name']}({params})"
+
+
+def wrapper(intrinsic, adapt):
+    """C API function calling the __intrinsic_* form. If adapt is set, scalar
+    arguments are splatted to vectors and scalar results extracted from lane
+    0, matching an __intrinsic_* function over v128 values."""
+    args = []
+    for arg in intrinsic["arguments"]:
+        ty, name = parse_arg(arg)
+        if adapt and not vector_type(ty):
+            width = scalar_width(ty)
+            args.append(f"wasm_u{width}x{128 // width}_splat({name})")
+        else:
+            args.append(name)
+
+    call = f"__intrinsic_{intrinsic['name']}({', '.join(args)})"
+    ret = intrinsic["return_type"]["value"]
+    if adapt and not vector_type(ret):
+        width = scalar_width(ret)
+        call = f"wasm_u{width}x{128 // width}_extract_lane({call}, 0)"
+
+    return f"static inline {signature(intrinsic)} {{\n    return {call};\n}}"
+
+
+def engine_declaration(intrinsic):
+    params = []
+    for arg in intrinsic["arguments"]:
+        ty, name = parse_arg(arg)
+        params.append(f"{ty if vector_type(ty) else 'v128_t'} {name}")
+    ret = intrinsic["return_type"]["value"]
+    ret = ret if vector_type(ret) else "v128_t"
+    return f"{ret} __intrinsic_{intrinsic['name']}({', '.join(params)});"
+
+
+def engine_fallback_definition(hwwasm, intrinsic):
+    """Fallback definition of an engine intrinsic, or None if it is
+    hand-written."""
+    if intrinsic["name"] in HANDWRITTEN_FALLBACKS:
+        return None
+    return fallback_definition(hwwasm, intrinsic, vector_params=True)
+
+
+def generate(intrinsics, hwwasm, header_name):
+    header = Output()
+    source = Output()
+
+    header.line("// Code generated by tools/generate_intrinsics.py. DO NOT EDIT.")
+    header.line()
+    header.line("#pragma once")
+    header.line()
+    header.line("#include <wasm_simd128.h>")
+
+    source.line("// Code generated by tools/generate_intrinsics.py. DO NOT EDIT.")
+    source.line()
+    source.line(f'#include "{header_name}"')
+
+    # Intrinsics.
+    body = Output()
+    types = set()
     for intrinsic in intrinsics:
-        if intrinsic["name"] not in ENABLED_INTRINSICS:
+        name = intrinsic["name"]
+        try:
+            direct = direct_body(intrinsic)
+            if direct is not None:
+                decls = [f"static inline {signature(intrinsic)} {{\n{indent(direct)}\n}}"]
+                definition = None
+            elif name in ENGINE_INTRINSICS:
+                decls = [engine_declaration(intrinsic), wrapper(intrinsic, adapt=True)]
+                definition = engine_fallback_definition(hwwasm, intrinsic)
+            else:
+                fallback = fallback_definition(hwwasm, intrinsic, vector_params=False)
+                decls = ["static inline " + fallback, wrapper(intrinsic, adapt=False)]
+                definition = None
+        except (Unsupported, OSError, subprocess.CalledProcessError) as e:
+            print(f"{name}: skipped: {e}", file=sys.stderr)
             continue
 
-        params = ", ".join(intrinsic["arguments"])
-        args = ", ".join(arg.split()[-1] for arg in intrinsic["arguments"])
-        ret = intrinsic["return_type"]["value"]
-        name = intrinsic["name"]
-        builtin_name = f"__intrinsic_{name}"
+        body.line()
+        body.line(f"// {name}")
+        for decl in decls:
+            body.line()
+            body.block(decl)
+
+        if definition is not None:
+            source.line()
+            source.block(definition)
+
+        for arg in intrinsic["arguments"]:
+            types.add(parse_arg(arg)[0].replace("const ", "").rstrip(" *"))
+        types.add(intrinsic["return_type"]["value"])
+
+    # Vector typedefs.
+    header.line()
+    for ty in sorted(types):
+        if VECTOR_TYPE_RE.fullmatch(ty):
+            header.line(f"typedef v128_t {ty};")
+    header.lines.extend(body.lines)
+
+    return header.text(), source.text()
 
-        print(f"// {name}")
-        print()
-        print(f"{ret} {builtin_name}({params});")
-        print()
-        print(f"static inline {ret} {name}({params}) {{ return {builtin_name}({args}); }}")
-        print()
+
+def indent(text):
+    return "\n".join("    " + line for line in text.split("\n"))
+
+
+def select(intrinsics, patterns):
+    selected = []
+    for intrinsic in intrinsics:
+        name = intrinsic["name"]
+        if any(fnmatch.fnmatchcase(name, pattern) for pattern in patterns):
+            selected.append(intrinsic)
+    return selected
 
 
 def main():
-    intrinsics = read_intrinsics_database()
-    generate_c_header_declarations(intrinsics)
+    parser = argparse.ArgumentParser(description=__doc__.strip().split("\n")[0])
+    parser.add_argument(
+        "patterns",
+        nargs="*",
+        default=sorted(ENABLED_INTRINSICS),
+        help="intrinsic names or glob patterns to generate (default: SHA-1 example set)",
+    )
+    parser.add_argument("--header", required=True, help="output header path")
+    parser.add_argument("--source", required=True, help="output source path")
+    parser.add_argument(
+        "--hwwasm",
+        default=os.getenv("HWWASM_BIN", os.path.join(REPO_DIR, "hwwasm/target/release/hwwasm")),
+        help="hwwasm translator binary",
+    )
+    args = parser.parse_args()
+
+    intrinsics = select(read_intrinsics_database(), args.patterns)
+    header, source = generate(intrinsics, args.hwwasm, os.path.basename(args.header))
+
+    with open(args.header, "w") as f:
+        f.write(header)
+    with open(args.source, "w") as f:
+        f.write(source)
 
 
 if __name__ == "__main__":